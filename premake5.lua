@@ -11,7 +11,8 @@ minko.project.solution(PROJECT_NAME)
 	minko.project.application(PROJECT_NAME)
 
 		files { "src/**.cpp", "src/**.hpp", "asset/**", "include/**.hpp" }
-		includedirs { "src", "include" }
+		excludes { "src/sim.cpp" }
+		includedirs { "src", "include", MINKO_HOME .. "/framework/lib/jsoncpp/src" }
 
 		-- plugin
 		minko.plugin.enable("sdl")
@@ -22,3 +23,14 @@ minko.project.solution(PROJECT_NAME)
 		minko.plugin.enable("png")
 		minko.plugin.enable("jpeg")
 		minko.plugin.enable("oculus")
+
+	-- headless fixed-timestep simulation of the gameplay scripts (no rendering, no audio)
+	minko.project.application("trex-sim")
+
+		files { "src/**.cpp", "src/**.hpp", "include/**.hpp" }
+		excludes { "src/main.cpp" }
+		includedirs { "src", "include", MINKO_HOME .. "/framework/lib/jsoncpp/src" }
+		defines { "TREX_HEADLESS" }
+
+		-- plugin
+		minko.plugin.enable("sdl")
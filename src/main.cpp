@@ -24,8 +24,10 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "minko/MinkoSerializer.hpp"
 #include "minko/MinkoParticles.hpp"
 
+#include "trex/SimulationClock.hpp"
 #include "trex/component/CarScript.hpp"
 #include "trex/component/DinoScript.hpp"
+#include "trex/component/DinoHerd.hpp"
 #include "trex/component/RoadScript.hpp"
 #include "trex/component/RumbleScript.hpp"
 #include "trex/component/MirrorScript.hpp"
@@ -52,10 +54,22 @@ int main(int argc, char** argv)
     std::srand((unsigned int) (std::time(nullptr)));
 
     auto canvas = Canvas::create("Oculus Rex", 1280, 720, Canvas::RESIZABLE);
-    canvas->desiredFramerate(120.f);
+    canvas->desiredFramerate(TREX_FRAMERATE);
 
     auto sceneManager = SceneManager::create(canvas->context());
 
+    // usage: oculus-rex [--time-scale scale] [--dinos numDinos]
+    auto clock = SimulationClock::create();
+    auto numDinos = 0;
+
+    for (auto i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--time-scale")
+            clock->timeScale(float(std::atof(argv[++i])));
+        else if (std::string(argv[i]) == "--dinos")
+            numDinos = std::atoi(argv[++i]);
+    }
+
     sceneManager->assets()->loader()->options()
         ->generateMipmaps(true)
         ->registerParser<file::PNGParser>("png")
@@ -87,8 +101,8 @@ int main(int argc, char** argv)
             phongMaterial
                 ->fogType(render::FogType::Exponential)
                 ->fogColor(TREX_FOG_COLOR)
-                ->fogStart(TREX_ROAD_CHUNK_LENGTH / 2)
-                ->fogEnd(TREX_FRONT_VIEW_DISTANCE - TREX_ROAD_CHUNK_LENGTH)
+                ->fogStart(TREX_FOG_START)
+                ->fogEnd(TREX_FOG_END)
                 ->fogDensity(1.0f);
 
             return phongMaterial;
@@ -160,8 +174,8 @@ int main(int argc, char** argv)
     auto road    = scene::Node::create("road");
     auto mirrors = scene::Node::create("mirrors");
 
-    car->addComponent(CarScript::create(canvas, root));
-    dino->addComponent(DinoScript::create(root));
+    car->addComponent(CarScript::create(canvas, root, clock));
+    dino->addComponent(DinoScript::create(root, car->component<CarScript>()));
     road->addComponent(RoadScript::create(car));
     mirrors->addComponent(MirrorScript::create(sceneManager->assets(), sceneManager, canvas, root, car));
 
@@ -195,6 +209,15 @@ int main(int argc, char** argv)
         root->addChild(road);
         root->addChild(mirrors);
 
+        // herd mode: extra dinos chasing the car behind the main one
+        if (numDinos > 0)
+        {
+            auto herd = scene::Node::create("herd");
+
+            herd->addComponent(DinoHerd::create(car->component<CarScript>(), numDinos));
+            root->addChild(herd);
+        }
+
 #ifdef CAR_RUMBLE_ENABLE
         auto rumble = scene::Node::create("rumble");
         rumble->addComponent(RumbleScript::create(car, road));
@@ -217,7 +240,7 @@ int main(int argc, char** argv)
 
     auto enterFrame = canvas->enterFrame()->connect([&](Canvas::Ptr canvas, float time, float deltaTime)
     {
-        sceneManager->nextFrame(time, deltaTime);
+        clock->frame(sceneManager, deltaTime);
     });
 
     fxLoader->load();
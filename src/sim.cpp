@@ -0,0 +1,132 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <chrono>
+
+#include "minko/Minko.hpp"
+#include "minko/MinkoSDL.hpp"
+
+#include "trex/Config.hpp"
+#include "trex/SimulationClock.hpp"
+#include "trex/component/CarScript.hpp"
+#include "trex/component/DinoHerd.hpp"
+#include "trex/component/DinoScript.hpp"
+#include "trex/component/RoadScript.hpp"
+#include "trex/component/RumbleScript.hpp"
+
+using namespace minko;
+using namespace minko::component;
+
+using namespace trex;
+using namespace trex::component;
+
+// Headless run of the gameplay scripts: no Canvas, no GL context, no audio. The scene
+// is stepped by a fixed-step clock as fast as possible.
+//
+// usage: trex-sim [--dinos numDinos] [numFrames] [seed]
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    auto numDinos = 0;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--dinos" && i + 1 < argc)
+            numDinos = std::atoi(argv[++i]);
+        else
+            args.push_back(argv[i]);
+    }
+
+    auto numFrames = args.size() > 0 ? std::atoi(args[0].c_str()) : TREX_SIM_NUM_FRAMES;
+    auto seed = args.size() > 1 ? std::atoi(args[1].c_str()) : TREX_SIM_SEED;
+
+    std::srand((unsigned int) seed);
+
+    auto sceneManager = SceneManager::create(nullptr);
+
+    auto root = scene::Node::create("root")
+        ->addComponent(sceneManager);
+
+    auto car    = scene::Node::create("car");
+    auto dino   = scene::Node::create("dino");
+    auto road   = scene::Node::create("road");
+
+    auto clock = SimulationClock::create(TREX_SIM_TIME_STEP);
+    auto carScript = CarScript::create(nullptr, root, clock);
+
+    car->addComponent(carScript);
+    dino->addComponent(DinoScript::create(root, carScript));
+    road->addComponent(RoadScript::create(car));
+
+    root->addChild(car);
+    root->addChild(dino);
+    root->addChild(road);
+
+    auto herd = DinoHerd::create(carScript, numDinos);
+
+    if (numDinos > 0)
+    {
+        auto herdNode = scene::Node::create("herd");
+
+        herdNode->addComponent(herd);
+        root->addChild(herdNode);
+    }
+
+#ifdef CAR_RUMBLE_ENABLE
+    auto rumble = scene::Node::create("rumble");
+    rumble->addComponent(RumbleScript::create(car, road));
+    root->addChild(rumble);
+#endif
+
+    auto wallClockStart = std::chrono::high_resolution_clock::now();
+
+    for (auto frame = 0; frame < numFrames; ++frame)
+    {
+        // scripts are started during the first frame
+        if (frame == 1)
+            carScript->startGame();
+
+        if (frame > 0 && frame % TREX_SIM_LANE_CHANGE_PERIOD == 0)
+        {
+            if (std::rand() % 2)
+                carScript->turnLeft();
+            else
+                carScript->turnRight();
+        }
+
+        clock->step(sceneManager);
+    }
+
+    auto wallClockTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - wallClockStart
+    ).count();
+
+    std::cout << "simulated frames: " << numFrames
+              << " (" << clock->time() / 1000.f << "s of game time)" << std::endl;
+    std::cout << "wall clock time: " << wallClockTime << "ms" << std::endl;
+    std::cout << "simulated frames per second: "
+              << (wallClockTime > 0 ? numFrames * 1000.f / wallClockTime : 0.f) << std::endl;
+    std::cout << "car distance: " << carScript->distance() << std::endl;
+
+    if (numDinos > 0)
+        std::cout << "herd: " << numDinos << " dinos, mean distance to car: "
+                  << herd->meanDistanceToCar() << std::endl;
+
+    return 0;
+}
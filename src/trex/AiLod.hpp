@@ -0,0 +1,70 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    // AI level of detail: actors far from the car run their AI (lane checks, speed and
+    // state updates) on a fraction of the frames only, and extrapolate their motion in
+    // between. Tiers only depend on the distance and the frame number, and actors of a
+    // tier are spread over its period by their id, so that a run is reproducible and the
+    // cost of a frame stays even.
+    class AiLod
+    {
+    public:
+        enum Tier
+        {
+            CLOSE,
+            MIDDLE,
+            DISTANT,
+            NUM_TIERS
+        };
+
+    public:
+        static
+        inline
+        Tier
+        tier(float distance)
+        {
+            return distance < TREX_AI_LOD_NEAR_DISTANCE
+                ? CLOSE
+                : (distance < TREX_AI_LOD_FAR_DISTANCE ? MIDDLE : DISTANT);
+        }
+
+        static
+        inline
+        unsigned int
+        period(Tier tier)
+        {
+            return tier == CLOSE ? 1 : (tier == MIDDLE ? TREX_AI_LOD_MIDDLE_PERIOD : TREX_AI_LOD_FAR_PERIOD);
+        }
+
+        // Whether the actor runs its AI on this frame.
+        static
+        inline
+        bool
+        ticks(unsigned int frame, unsigned int actor, float distance)
+        {
+            return (frame + actor) % period(tier(distance)) == 0;
+        }
+    };
+}
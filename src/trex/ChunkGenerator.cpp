@@ -0,0 +1,164 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ChunkGenerator.hpp"
+
+using namespace trex;
+
+ChunkGenerator::ChunkGenerator(unsigned int seed, unsigned int capacity) :
+    _random(seed),
+    _previousProp(0),
+    _capacity(capacity)
+#if !defined(EMSCRIPTEN)
+    , _running(false)
+#endif
+{
+}
+
+ChunkGenerator::~ChunkGenerator()
+{
+#if !defined(EMSCRIPTEN)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _running = false;
+    }
+
+    _layoutPopped.notify_all();
+
+    if (_worker.joinable())
+        _worker.join();
+#endif
+}
+
+void
+ChunkGenerator::initialize()
+{
+#if !defined(EMSCRIPTEN)
+    _running = true;
+    _worker = std::thread(&ChunkGenerator::run, this);
+#endif
+}
+
+bool
+ChunkGenerator::next(ChunkLayout& layout, bool wait)
+{
+#if defined(EMSCRIPTEN)
+    generate(layout);
+
+    return true;
+#else
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (wait)
+        _layoutPushed.wait(lock, [&]() { return !_layouts.empty(); });
+    else if (_layouts.empty())
+        return false;
+
+    layout = _layouts.front();
+    _layouts.pop_front();
+
+    lock.unlock();
+    _layoutPopped.notify_one();
+
+    return true;
+#endif
+}
+
+#if !defined(EMSCRIPTEN)
+void
+ChunkGenerator::run()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            _layoutPopped.wait(lock, [&]() { return !_running || _layouts.size() < _capacity; });
+
+            if (!_running)
+                return;
+        }
+
+        // _random and _previousProp are only touched by the worker
+        ChunkLayout layout;
+
+        generate(layout);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            _layouts.push_back(layout);
+        }
+
+        _layoutPushed.notify_one();
+    }
+}
+#endif
+
+int
+ChunkGenerator::randomInt(int max)
+{
+    return std::uniform_int_distribution<int>(0, max - 1)(_random);
+}
+
+float
+ChunkGenerator::randomFloat(float max)
+{
+    return std::uniform_real_distribution<float>(0.f, max)(_random);
+}
+
+void
+ChunkGenerator::generate(ChunkLayout& layout)
+{
+    const float propSize = float(TREX_ROAD_CHUNK_LENGTH) / float(TREX_ROAD_CHUNK_NUM_PROPS);
+
+    for (auto side = 0; side < 2; ++side)
+    {
+        for (auto propId = 0; propId < TREX_ROAD_CHUNK_NUM_PROPS; ++propId)
+        {
+            auto prop = 0;
+            do
+            {
+                prop = randomInt(TREX_ROAD_NUM_PROP_MODELS);
+            } while (prop == _previousProp);
+
+            _previousProp = prop;
+
+            layout.props[side][propId] = prop;
+            layout.propOffsets[side][propId] = propId * propSize;
+        }
+    }
+
+    layout.numObstacles = 1 + randomInt(TREX_ROAD_CHUNK_MAX_OBSTACLES);
+
+    // unused obstacle slots still get a valid layout, they are just hidden
+    for (auto i = 0; i < TREX_ROAD_CHUNK_MAX_OBSTACLES; ++i)
+    {
+        auto& obstacle = layout.obstacles[i];
+
+        obstacle.model = randomInt(TREX_ROAD_NUM_TRUNK_MODELS);
+        obstacle.lane = randomInt(NUM_LANES);
+        obstacle.z = float(TREX_ROAD_CHUNK_LENGTH) * (i + 1) / (layout.numObstacles + 1);
+    }
+
+    layout.lightWellX = float(randomInt(5));
+    layout.lightWellZ = float(randomInt(100));
+    layout.lianaZ = randomFloat(float(TREX_ROAD_CHUNK_LENGTH));
+}
@@ -0,0 +1,117 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <deque>
+#include <random>
+
+#if !defined(EMSCRIPTEN)
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+#endif
+
+#include "minko/Minko.hpp"
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    // Everything that varies from one road chunk to another.
+    struct ChunkLayout
+    {
+        struct Obstacle
+        {
+            int     model;
+            int     lane;
+            float   z;
+        };
+
+        std::array<std::array<int, TREX_ROAD_CHUNK_NUM_PROPS>, 2>      props;
+        std::array<std::array<float, TREX_ROAD_CHUNK_NUM_PROPS>, 2>    propOffsets;
+        std::array<Obstacle, TREX_ROAD_CHUNK_MAX_OBSTACLES>             obstacles;
+        int                                                             numObstacles;
+        float                                                           lightWellX;
+        float                                                           lightWellZ;
+        float                                                           lianaZ;
+    };
+
+    // Generates chunk layouts from a seed on a worker thread, ahead of the car. The
+    // main thread only pops ready layouts. Without threads (EMSCRIPTEN), layouts are
+    // generated on demand.
+    class ChunkGenerator
+    {
+    public:
+        typedef std::shared_ptr<ChunkGenerator> Ptr;
+
+    private:
+        std::minstd_rand                _random;
+        int                             _previousProp;
+        std::deque<ChunkLayout>         _layouts;
+        unsigned int                    _capacity;
+
+#if !defined(EMSCRIPTEN)
+        std::thread                     _worker;
+        std::mutex                      _mutex;
+        std::condition_variable         _layoutPopped;
+        std::condition_variable         _layoutPushed;
+        bool                            _running;
+#endif
+
+    public:
+        ~ChunkGenerator();
+
+        static
+        Ptr
+        create(unsigned int seed, unsigned int capacity = TREX_CHUNK_GENERATOR_QUEUE_SIZE)
+        {
+            auto generator = std::shared_ptr<ChunkGenerator>(new ChunkGenerator(seed, capacity));
+
+            generator->initialize();
+
+            return generator;
+        }
+
+        // Pops the next layout. Returns false if none is ready yet, unless wait is true.
+        bool
+        next(ChunkLayout& layout, bool wait = false);
+
+    private:
+        ChunkGenerator(unsigned int seed, unsigned int capacity);
+
+        void
+        initialize();
+
+        void
+        generate(ChunkLayout& layout);
+
+        int
+        randomInt(int max);
+
+        float
+        randomFloat(float max);
+
+#if !defined(EMSCRIPTEN)
+        void
+        run();
+#endif
+    };
+}
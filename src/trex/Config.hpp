@@ -21,6 +21,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 
 #define DINO_DIST 7.f
 
+// the frame rate the game runs at, and the one the per-frame values were tuned for
+#define TREX_FRAMERATE                                      120.f
+
 #define WALKING_TO_FOLLOWING_TIME                           1.0f
 #define FOLLOWING_TO_WALKING_TIME                           1.0f
 
@@ -32,15 +35,32 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #define TREX_FRONT_VIEW_DISTANCE                            200
 #define TREX_BACK_VIEW_DISTANCE                             200
 #define TREX_CHUNK_POOL_SIZE                                10
+#define TREX_CHUNK_GENERATOR_QUEUE_SIZE                     16
+#define TREX_ROAD_CHUNK_NUM_PROPS                           5
+#define TREX_ROAD_CHUNK_MAX_OBSTACLES                       1
+#define TREX_ROAD_NUM_PROP_MODELS                           5
+#define TREX_ROAD_NUM_TRUNK_MODELS                          4
+#define TREX_ORIGIN_SHIFT_DISTANCE                          (TREX_ROAD_CHUNK_LENGTH * 20)
+#define TREX_FOG_START                                      (TREX_ROAD_CHUNK_LENGTH / 2)
+#define TREX_FOG_END                                        (TREX_FRONT_VIEW_DISTANCE - TREX_ROAD_CHUNK_LENGTH)
+#define TREX_LOD_HYSTERESIS                                 5.f
+#define TREX_IMPOSTOR_DISTANCE                              (TREX_FRONT_VIEW_DISTANCE / 2)
+#define TREX_IMPOSTOR_TEXTURE_SIZE                          256
+// the baked models are seen from far away, so that their impostor is close to an orthographic view
+#define TREX_IMPOSTOR_CAMERA_DISTANCE                       1000.f
+// vertical gap between two baked models, so that each camera only sees its own
+#define TREX_IMPOSTOR_MODEL_SPACING                         1000.f
 #define TREX_FOG_COLOR                                      minko::math::Vector4::create(5.0f/ 255.0f, 5.0f/ 255.0f, 14.0f/ 255.0f, 1.0f)
 #define NUM_LANES                                           3
 
 #define CAR_BASE_SPEED                                      60.f
 #define CAR_INTRO_SPEED                                     0.0f
+#define CAR_EATEN_DECELERATION                              (0.5f * TREX_FRAMERATE / 1000.f)
 #define CAR_WIDTH                                           1.75f
 #define CAR_HEIGHT                                          1.75f
 #define CAR_LENGTH                                          3.9f
 #define CAR_SCORE_ENABLE
+#define CAR_SCORE_SINGLE_DRAW
 
 #define CAR_RUMBLE_ENABLE
 #define CAR_RUMBLE_LVL                                      50
@@ -57,13 +77,23 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #define MOVE_THRESHOLD                                      0.4f
 #define CAMERA_THRESHOLD                                    0.3f
 #define CAMERA_V_LIMIT                                      (M_PI_2 / 3.f)
+#define TREX_CAMERA_FOV                                     1.0f
 
 #define LANE_CHANGE_DURATION                                450
+// yaw, halfway, of a change to the next lane and of a change over two lanes
+#define ADJACENT_LANE_YAW                                   (float(M_PI_4) / 5.5f)
+#define FAR_LANE_YAW                                        (float(M_PI_4) / 2.f)
 
 #define ROAD_COLLISION_ENABLE
 #define ROAD_COLLISION_SLOWDOWN                             20
 #define ROAD_COLLISION_ACCELERATION                         2
 
+#define ROAD_COLLISION_INTERVAL                             (1000.f / 30.f)
+
+#define TREX_OBSTACLE_WIDTH                                 2.f
+#define TREX_OBSTACLE_LENGTH                                1.f
+#define TREX_OBSTACLE_CELL_LENGTH                           5
+
 #define TREX_DINO_IDLE_STATE_DURATION                       5.0f
 
 #define TREX_DINO_INTRO_SPEED                               35.f
@@ -83,7 +113,56 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #define TREX_DINO_WALKING_TO_SCREAMING_STATE_DELAY          1.0f
 #define TREX_DINO_AFTER_ATTACKING_WALKING_STATE_DURATION    2.0f
 
+// skeletal animation LOD: screen sizes are fractions of the screen height
+#define TREX_DINO_HEIGHT                                    5.f
+#define TREX_ANIMATION_LOD_FULL_SIZE                        .25f
+#define TREX_ANIMATION_LOD_HALF_SIZE                        .1f
+#define TREX_ANIMATION_LOD_HALF_STEP                        33
+#define TREX_ANIMATION_LOD_LOW_STEP                         100
+
+// the main dino stays in the near tier in normal play
+#define TREX_AI_LOD_NEAR_DISTANCE                           (TREX_DINO_LENGTH + TREX_DINO_STARTING_DIST)
+#define TREX_AI_LOD_FAR_DISTANCE                            TREX_FOG_END
+#define TREX_AI_LOD_MIDDLE_PERIOD                           2
+#define TREX_AI_LOD_FAR_PERIOD                              8
+
+#define TREX_HERD_ROW_SPACING                               (TREX_DINO_LENGTH * 1.5f)
+#define TREX_HERD_CATCH_UP                                  2.f
+
+#define TREX_NUM_VOICES                                     8
+#define TREX_SOUND_PRIORITY_STEP                            0
+#define TREX_SOUND_PRIORITY_RUSH                            1
+#define TREX_SOUND_PRIORITY_ROAR                            2
+#define TREX_SOUND_PRIORITY_ATTACK                          3
+#define TREX_SOUND_PRIORITY_EAT                             4
+#define TREX_SOUND_REFERENCE_DISTANCE                       (TREX_DINO_LENGTH / 2 + TREX_DINO_DIST)
+#define TREX_SOUND_MAX_DISTANCE                             (TREX_DINO_STARTING_DIST * 2)
+#define TREX_SOUND_ROLLOFF                                  1.f
+#define TREX_SOUND_AUDIBILITY_THRESHOLD                     0.05f
+
+// optional override of the states of DinoScript::defaultStates(), which use the constants
+// above; none is shipped
+#define TREX_DINO_STATES_FILENAME                           "config/dino_states.json"
+
+#define TREX_GAME_OVER_ANIMATION_SCALE                      (1.f / 3.f)
+
 #define TREX_GOD_MODE                                       false
 
 #define TREX_ENABLE_LIGHTWELL
-#define TREX_ENABLE_PARTICLES                               true
\ No newline at end of file
+
+#ifndef TREX_HEADLESS
+# define TREX_ENABLE_CHUNK_MERGING
+# define TREX_ENABLE_IMPOSTORS
+# define TREX_ENABLE_LATENCY_PROBE
+#endif
+
+#ifdef TREX_HEADLESS
+# define TREX_ENABLE_PARTICLES                              false
+#else
+# define TREX_ENABLE_PARTICLES                              true
+#endif
+
+#define TREX_SIM_TIME_STEP                                  (1000.f / TREX_FRAMERATE)
+#define TREX_SIM_NUM_FRAMES                                 72000
+#define TREX_SIM_SEED                                       42
+#define TREX_SIM_LANE_CHANGE_PERIOD                         90
\ No newline at end of file
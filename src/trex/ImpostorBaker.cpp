@@ -0,0 +1,142 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ImpostorBaker.hpp"
+
+using namespace minko;
+using namespace minko::component;
+using namespace minko::math;
+using namespace trex;
+
+ImpostorBaker::ImpostorBaker(render::AbstractContext::Ptr context, render::Effect::Ptr effect) :
+    _context(context),
+    _effect(effect),
+    _sceneManager(SceneManager::create(context)),
+    _studio(scene::Node::create("impostorStudio")),
+    _quad(geometry::QuadGeometry::create(context))
+{
+    _studio->addComponent(_sceneManager);
+}
+
+unsigned int
+ImpostorBaker::add(scene::Node::Ptr model)
+{
+    const auto infinity = std::numeric_limits<float>::max();
+    auto min = Vector3::create(infinity, infinity, infinity);
+    auto max = Vector3::create(-infinity, -infinity, -infinity);
+    auto position = Vector3::create();
+
+    auto surfaceNodes = scene::NodeSet::create(model)
+        ->descendants(false)
+        ->where([](scene::Node::Ptr n)
+    {
+        return n->hasComponent<Surface>();
+    });
+
+    for (auto node : surfaceNodes->nodes())
+    {
+        auto surface = node->component<Surface>();
+        auto matrix = Matrix4x4::create();
+
+        for (auto n = node; n != model; n = n->parent())
+            if (n->hasComponent<Transform>())
+                matrix->append(n->component<Transform>()->matrix());
+
+        // the impostor is fogged in the scene, the model must not be
+        auto material = material::PhongMaterial::create();
+
+        material->copyFrom(surface->material());
+        material->fogType(render::FogType::None);
+        surface->material(material);
+
+        for (auto vertexBuffer : surface->geometry()->vertexBuffers())
+        {
+            if (!vertexBuffer->hasAttribute("position"))
+                continue;
+
+            const auto& data = vertexBuffer->data();
+            const auto offset = std::get<2>(*vertexBuffer->attribute("position"));
+
+            for (auto i = 0u; i < data.size(); i += vertexBuffer->vertexSize())
+            {
+                matrix->transform(position->setTo(data[i + offset], data[i + offset + 1], data[i + offset + 2]), position);
+                min->setTo(std::min(min->x(), position->x()), std::min(min->y(), position->y()), std::min(min->z(), position->z()));
+                max->setTo(std::max(max->x(), position->x()), std::max(max->y(), position->y()), std::max(max->z(), position->z()));
+            }
+        }
+    }
+
+    const auto index = static_cast<unsigned int>(_impostors.size());
+    const auto y = float(index) * TREX_IMPOSTOR_MODEL_SPACING;
+    auto width = std::max(max->z() - min->z(), 0.01f);
+    auto height = std::max(max->y() - min->y(), 0.01f);
+    auto center = Vector3::create((min->x() + max->x()) * .5f, (min->y() + max->y()) * .5f, (min->z() + max->z()) * .5f);
+    auto texture = render::Texture::create(_context, TREX_IMPOSTOR_TEXTURE_SIZE, TREX_IMPOSTOR_TEXTURE_SIZE, false, true);
+
+    model->component<Transform>()->matrix()
+        ->identity()
+        ->appendTranslation(0.f, y, 0.f);
+    _studio->addChild(model);
+
+    _studio->addChild(scene::Node::create("impostorCamera")
+        ->addComponent(Renderer::create(0x00000000, texture))
+        ->addComponent(PerspectiveCamera::create(
+            width / height,
+            2.f * std::atan(height * .5f / TREX_IMPOSTOR_CAMERA_DISTANCE),
+            TREX_IMPOSTOR_CAMERA_DISTANCE * .5f,
+            TREX_IMPOSTOR_CAMERA_DISTANCE + max->x() - min->x() + 1.f
+        ))
+        ->addComponent(Transform::create(Matrix4x4::create()->lookAt(
+            Vector3::create(center->x(), center->y() + y, center->z()),
+            Vector3::create(min->x() - TREX_IMPOSTOR_CAMERA_DISTANCE, center->y() + y, center->z())
+        )))
+    );
+
+    auto material = material::PhongMaterial::create();
+
+    material
+        ->diffuseMap(texture)
+        ->fogType(render::FogType::Exponential)
+        ->fogColor(TREX_FOG_COLOR)
+        ->fogStart(TREX_FOG_START)
+        ->fogEnd(TREX_FOG_END)
+        ->fogDensity(1.0f);
+    material->set("triangleCulling", render::TriangleCulling::NONE);
+    material->set("alphaThreshold", .5f);
+
+    _impostors.push_back({
+        texture,
+        material,
+        Matrix4x4::create()
+            ->appendScale(width, height, 1.f)
+            ->appendRotationY(-float(M_PI_2))
+            ->appendTranslation(min->x(), center->y(), center->z())
+    });
+
+    return index;
+}
+
+void
+ImpostorBaker::bake()
+{
+    _sceneManager->nextFrame(0.f, 0.f);
+
+    while (!_studio->children().empty())
+        _studio->removeChild(_studio->children().back());
+}
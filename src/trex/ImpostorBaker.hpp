@@ -0,0 +1,93 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    // Renders models, seen from -x, into textures that far copies of these models can be
+    // swapped for. The models are rendered without fog in a scene of their own; the
+    // impostor materials are fogged like the rest of the road.
+    class ImpostorBaker
+    {
+    public:
+        typedef std::shared_ptr<ImpostorBaker>  Ptr;
+
+        struct Impostor
+        {
+            minko::render::Texture::Ptr     texture;
+            minko::material::Material::Ptr  material;
+            // the quad, in the space of the model, on the side of the model facing -x
+            minko::math::Matrix4x4::Ptr     matrix;
+        };
+
+    private:
+        minko::render::AbstractContext::Ptr         _context;
+        minko::render::Effect::Ptr                  _effect;
+        minko::component::SceneManager::Ptr         _sceneManager;
+        minko::scene::Node::Ptr                     _studio;
+        minko::geometry::Geometry::Ptr              _quad;
+        std::vector<Impostor>                       _impostors;
+
+    public:
+        static
+        Ptr
+        create(minko::render::AbstractContext::Ptr context, minko::render::Effect::Ptr effect)
+        {
+            return std::shared_ptr<ImpostorBaker>(new ImpostorBaker(context, effect));
+        }
+
+        inline
+        minko::geometry::Geometry::Ptr
+        quad() const
+        {
+            return _quad;
+        }
+
+        inline
+        minko::render::Effect::Ptr
+        effect() const
+        {
+            return _effect;
+        }
+
+        inline
+        const Impostor&
+        impostor(unsigned int index) const
+        {
+            return _impostors[index];
+        }
+
+        // Adds a model to the next bake() and returns the index of its impostor. The model
+        // must not be in a scene: it is moved into the baking scene.
+        unsigned int
+        add(minko::scene::Node::Ptr model);
+
+        // Renders all the models added since the last call, then releases them.
+        void
+        bake();
+
+    private:
+        ImpostorBaker(minko::render::AbstractContext::Ptr context, minko::render::Effect::Ptr effect);
+    };
+}
@@ -0,0 +1,206 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <chrono>
+
+#include "InputMapper.hpp"
+
+using namespace minko;
+using namespace minko::input;
+using namespace trex;
+
+InputMapper::InputMapper(Canvas::Ptr canvas) :
+    _canvas(canvas),
+    _keyLookX(0.f),
+    _joystickLookX(0.f),
+    _joystickLookY(0.f),
+    _joystick(nullptr)
+{
+    _keyDown.fill(false);
+    _joystickDown.fill(false);
+
+    _pending.frame = 0;
+    _pending.time = now();
+    _pending.down.fill(false);
+    _pending.pressed.fill(false);
+    _pending.released.fill(false);
+    _pending.eventTime.fill(0.0);
+    _pending.lookX = 0.f;
+    _pending.lookY = 0.f;
+
+    _snapshot = _pending;
+}
+
+double
+InputMapper::now()
+{
+    static const auto start = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void
+InputMapper::initialize()
+{
+    _keyBindings = {
+        { Keyboard::Key::LEFT,      InputSnapshot::TURN_LEFT },
+        { Keyboard::Key::RIGHT,     InputSnapshot::TURN_RIGHT },
+        { Keyboard::Key::F,         InputSnapshot::START },
+        { Keyboard::Key::END,       InputSnapshot::END_GAME },
+        { Keyboard::Key::ESCAPE,    InputSnapshot::QUIT }
+    };
+
+    auto keyboard = _canvas->keyboard();
+
+    // the button state comes from each key event rather than from the keyboard state,
+    // which may already reflect a later release of the key
+    for (const auto& binding : _keyBindings)
+    {
+        auto button = binding.button;
+
+        _keySlots.push_back(keyboard->keyDown(binding.key)->connect([=](Keyboard::Ptr, uint)
+        {
+            keyChanged(button, true);
+        }));
+        _keySlots.push_back(keyboard->keyUp(binding.key)->connect([=](Keyboard::Ptr, uint)
+        {
+            keyChanged(button, false);
+        }));
+    }
+
+    _keyDownSlot = keyboard->keyDown()->connect([&](Keyboard::Ptr keyboard)
+    {
+        lookKeysChanged(keyboard);
+    });
+    _keyUpSlot = keyboard->keyUp()->connect([&](Keyboard::Ptr keyboard)
+    {
+        lookKeysChanged(keyboard);
+    });
+
+    _joystickAdded = _canvas->joystickAdded()->connect([&](AbstractCanvas::Ptr canvas, JoystickPtr joystick)
+    {
+        if (_joystick != nullptr)
+            return;
+
+        _joystick = joystick;
+
+        _joystickAxisMotion = _joystick->joystickAxisMotion()->connect([&](JoystickPtr joystick, int which, int axis, int value)
+        {
+            joystickAxisChanged(axis, (float)(value) / 33000.f);
+        });
+
+        _joystickButtonDown = _joystick->joystickButtonDown()->connect([&](JoystickPtr joystick, int which, int button)
+        {
+            if (button == (int)Joystick::Button::A || button == (int)Joystick::Button::Start)
+            {
+                _joystickDown[InputSnapshot::START] = true;
+                updateButton(InputSnapshot::START);
+            }
+        });
+
+        _joystickButtonUp = _joystick->joystickButtonUp()->connect([&](JoystickPtr joystick, int which, int button)
+        {
+            if (button == (int)Joystick::Button::A || button == (int)Joystick::Button::Start)
+            {
+                _joystickDown[InputSnapshot::START] = false;
+                updateButton(InputSnapshot::START);
+            }
+        });
+    });
+
+    _joystickRemoved = _canvas->joystickRemoved()->connect([&](AbstractCanvas::Ptr canvas, JoystickPtr joystick)
+    {
+        if (_joystick != joystick)
+            return;
+
+        _joystick = nullptr;
+        _joystickDown.fill(false);
+        _joystickLookX = 0.f;
+        _joystickLookY = 0.f;
+
+        for (auto button = 0; button < InputSnapshot::NUM_BUTTONS; ++button)
+            updateButton(Button(button));
+    });
+}
+
+void
+InputMapper::keyChanged(Button button, bool down)
+{
+    _keyDown[button] = down;
+    updateButton(button);
+}
+
+void
+InputMapper::lookKeysChanged(Keyboard::Ptr keyboard)
+{
+    _keyLookX = 0.f;
+    if (keyboard->keyIsDown(Keyboard::Key::E))
+        _keyLookX -= 1.f;
+    if (keyboard->keyIsDown(Keyboard::Key::R))
+        _keyLookX += 1.f;
+}
+
+void
+InputMapper::joystickAxisChanged(int axis, float value)
+{
+    if (axis == AXIS_LX)
+    {
+        _joystickDown[InputSnapshot::TURN_LEFT] = -value > MOVE_THRESHOLD;
+        _joystickDown[InputSnapshot::TURN_RIGHT] = value > MOVE_THRESHOLD;
+        updateButton(InputSnapshot::TURN_LEFT);
+        updateButton(InputSnapshot::TURN_RIGHT);
+    }
+    else if (axis == AXIS_RX)
+        _joystickLookX = value;
+    else if (axis == AXIS_RY)
+        _joystickLookY = value;
+}
+
+void
+InputMapper::updateButton(Button button)
+{
+    auto down = _keyDown[button] || _joystickDown[button];
+
+    if (down == _pending.down[button])
+        return;
+
+    _pending.down[button] = down;
+    _pending.eventTime[button] = now();
+
+    if (down)
+        _pending.pressed[button] = true;
+    else
+        _pending.released[button] = true;
+}
+
+const InputSnapshot&
+InputMapper::next()
+{
+    _pending.time = now();
+    _pending.lookX = _keyLookX != 0.f ? _keyLookX : _joystickLookX;
+    _pending.lookY = _joystickLookY;
+
+    _snapshot = _pending;
+
+    ++_pending.frame;
+    _pending.pressed.fill(false);
+    _pending.released.fill(false);
+
+    return _snapshot;
+}
@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+#include "minko/MinkoSDL.hpp"
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    // The state of the game actions for one frame.
+    struct InputSnapshot
+    {
+        enum Button
+        {
+            TURN_LEFT,
+            TURN_RIGHT,
+            START,
+            END_GAME,
+            QUIT,
+            NUM_BUTTONS
+        };
+
+        unsigned int                        frame;
+        // when the snapshot was taken, in ms (see InputMapper::now())
+        double                              time;
+        std::array<bool, NUM_BUTTONS>       down;
+        // the button went down (resp. up) since the previous snapshot, even if it went
+        // back up (resp. down) before this one
+        std::array<bool, NUM_BUTTONS>       pressed;
+        std::array<bool, NUM_BUTTONS>       released;
+        // when the event that last changed the button was received
+        std::array<double, NUM_BUTTONS>     eventTime;
+        float                               lookX;
+        float                               lookY;
+
+        inline
+        bool
+        isDown(Button button) const
+        {
+            return down[button];
+        }
+
+        inline
+        bool
+        wasPressed(Button button) const
+        {
+            return pressed[button];
+        }
+    };
+
+    // Maps the keyboard and joystick events of a canvas to game actions, and collects
+    // them in one InputSnapshot per frame.
+    class InputMapper
+    {
+    public:
+        typedef std::shared_ptr<InputMapper>    Ptr;
+
+    private:
+        typedef minko::input::Joystick::Ptr                                                     JoystickPtr;
+        typedef minko::Signal<minko::input::Keyboard::Ptr>::Slot                                KeyboardSlot;
+        typedef minko::Signal<minko::input::Keyboard::Ptr, minko::uint>::Slot                   KeySlot;
+        typedef minko::Signal<minko::AbstractCanvas::Ptr, JoystickPtr>::Slot                    JoystickSlot;
+        typedef minko::Signal<JoystickPtr, int, int, int>::Slot                                 JoystickAxisMotionSlot;
+        typedef minko::Signal<JoystickPtr, int, int>::Slot                                      JoystickButtonSlot;
+        typedef InputSnapshot::Button                                                           Button;
+
+        struct KeyBinding
+        {
+            minko::input::Keyboard::Key key;
+            Button                      button;
+        };
+
+    private:
+        minko::Canvas::Ptr                                  _canvas;
+        std::vector<KeyBinding>                             _keyBindings;
+        std::array<bool, InputSnapshot::NUM_BUTTONS>        _keyDown;
+        std::array<bool, InputSnapshot::NUM_BUTTONS>        _joystickDown;
+        float                                               _keyLookX;
+        float                                               _joystickLookX;
+        float                                               _joystickLookY;
+        InputSnapshot                                       _pending;
+        InputSnapshot                                       _snapshot;
+
+        std::vector<KeySlot>                                _keySlots;
+        KeyboardSlot                                        _keyDownSlot;
+        KeyboardSlot                                        _keyUpSlot;
+        JoystickPtr                                         _joystick;
+        JoystickSlot                                        _joystickAdded;
+        JoystickSlot                                        _joystickRemoved;
+        JoystickAxisMotionSlot                              _joystickAxisMotion;
+        JoystickButtonSlot                                  _joystickButtonDown;
+        JoystickButtonSlot                                  _joystickButtonUp;
+
+    public:
+        static
+        Ptr
+        create(minko::Canvas::Ptr canvas)
+        {
+            auto mapper = std::shared_ptr<InputMapper>(new InputMapper(canvas));
+
+            mapper->initialize();
+
+            return mapper;
+        }
+
+        // Monotonic time in ms, the clock of the snapshots and of the event timestamps.
+        static
+        double
+        now();
+
+        // Takes the snapshot of a new frame: the edges collected since the previous one
+        // are consumed.
+        const InputSnapshot&
+        next();
+
+        inline
+        const InputSnapshot&
+        snapshot() const
+        {
+            return _snapshot;
+        }
+
+    private:
+        InputMapper(minko::Canvas::Ptr canvas);
+
+        void
+        initialize();
+
+        void
+        keyChanged(Button button, bool down);
+
+        void
+        lookKeysChanged(minko::input::Keyboard::Ptr keyboard);
+
+        void
+        joystickAxisChanged(int axis, float value);
+
+        void
+        updateButton(Button button);
+    };
+}
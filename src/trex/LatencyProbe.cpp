@@ -0,0 +1,87 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "LatencyProbe.hpp"
+
+using namespace trex;
+
+void
+LatencyProbe::laneChangeStarted(minko::uint frame, double eventTime, double consumedTime, double laneChangeTime)
+{
+    _pending.push_back({ frame, eventTime, consumedTime, laneChangeTime });
+}
+
+void
+LatencyProbe::framePresented(minko::uint frame, double presentedTime)
+{
+    auto numPending = 0u;
+
+    for (const auto& sample : _pending)
+    {
+        // a lane change started in this frame is not on screen yet
+        if (sample.frame >= frame)
+        {
+            _pending[numPending++] = sample;
+            continue;
+        }
+
+        _spans[EVENT_TO_CONSUMED].push_back(sample.consumedTime - sample.eventTime);
+        _spans[EVENT_TO_LANE_CHANGE].push_back(sample.laneChangeTime - sample.eventTime);
+        _spans[EVENT_TO_PRESENTED].push_back(presentedTime - sample.eventTime);
+    }
+
+    _pending.resize(numPending);
+}
+
+double
+LatencyProbe::percentile(Span span, double percent) const
+{
+    auto values = _spans[span];
+
+    if (values.empty())
+        return 0.0;
+
+    auto rank = static_cast<unsigned int>(std::ceil(percent / 100.0 * values.size()));
+    auto index = std::min<unsigned int>(std::max(rank, 1u), values.size()) - 1;
+
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+
+    return values[index];
+}
+
+void
+LatencyProbe::report(std::ostream& out) const
+{
+    static const std::array<std::string, NUM_SPANS> names = {
+        "event to consumed",
+        "event to lane change",
+        "event to presented"
+    };
+
+    out << "lane change latency over " << numSamples() << " samples (ms, p50/p90/p99/max)" << std::endl;
+
+    for (auto span = 0; span < NUM_SPANS; ++span)
+    {
+        out << "  " << names[span] << ": "
+            << percentile(Span(span), 50.0) << " / "
+            << percentile(Span(span), 90.0) << " / "
+            << percentile(Span(span), 99.0) << " / "
+            << percentile(Span(span), 100.0) << std::endl;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+namespace trex
+{
+    // Measures, for every lane change, the time from the input event to its consumption by
+    // the controls, to the start of the lane motion and to the first frame presented after
+    // it. All times are in ms, on the clock of InputMapper::now().
+    class LatencyProbe
+    {
+    public:
+        typedef std::shared_ptr<LatencyProbe>   Ptr;
+
+        enum Span
+        {
+            EVENT_TO_CONSUMED,
+            EVENT_TO_LANE_CHANGE,
+            EVENT_TO_PRESENTED,
+            NUM_SPANS
+        };
+
+    private:
+        struct Sample
+        {
+            minko::uint frame;
+            double eventTime;
+            double consumedTime;
+            double laneChangeTime;
+        };
+
+    private:
+        std::vector<Sample>                             _pending;
+        std::array<std::vector<double>, NUM_SPANS>      _spans;
+
+    public:
+        static
+        Ptr
+        create()
+        {
+            return std::shared_ptr<LatencyProbe>(new LatencyProbe());
+        }
+
+        // The frame is the one the lane change started in.
+        void
+        laneChangeStarted(minko::uint frame, double eventTime, double consumedTime, double laneChangeTime);
+
+        // Completes the lane changes started in frames before the given one: those frames
+        // were presented by the time it begins.
+        void
+        framePresented(minko::uint frame, double presentedTime);
+
+        // Returns the given percentile (in [0, 100]) of a span, or 0 without any sample.
+        double
+        percentile(Span span, double percent) const;
+
+        inline
+        unsigned int
+        numSamples() const
+        {
+            return _spans[EVENT_TO_PRESENTED].size();
+        }
+
+        void
+        report(std::ostream& out) const;
+
+    private:
+        LatencyProbe()
+        {
+        }
+    };
+}
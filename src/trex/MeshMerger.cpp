@@ -0,0 +1,175 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MeshMerger.hpp"
+
+using namespace minko;
+using namespace minko::math;
+using namespace trex;
+
+MeshMerger::MeshMerger(render::AbstractContext::Ptr context) :
+    _context(context),
+    _vertexSize(0),
+    _failed(false),
+    _input(Vector3::create()),
+    _output(Vector3::create())
+{
+}
+
+void
+MeshMerger::reset()
+{
+    _attributes.clear();
+    _vertexSize = 0;
+    _vertices.clear();
+    _indices.clear();
+    _failed = false;
+}
+
+bool
+MeshMerger::findAttribute(geometry::Geometry::Ptr   geometry,
+                          const Attribute&          attribute,
+                          VertexBufferPtr&          vertexBuffer,
+                          unsigned int&             offset) const
+{
+    for (auto vb : geometry->vertexBuffers())
+    {
+        for (auto attr : vb->attributes())
+        {
+            if (std::get<0>(*attr) == attribute.name && std::get<1>(*attr) == attribute.size)
+            {
+                vertexBuffer = vb;
+                offset = std::get<2>(*attr);
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool
+MeshMerger::add(geometry::Geometry::Ptr geometry, Matrix4x4::Ptr matrix)
+{
+    if (_failed)
+        return false;
+
+    if (_attributes.empty())
+    {
+        for (auto vb : geometry->vertexBuffers())
+        {
+            for (auto attr : vb->attributes())
+            {
+                _attributes.push_back({ std::get<0>(*attr), std::get<1>(*attr) });
+                _vertexSize += std::get<1>(*attr);
+            }
+        }
+    }
+
+    auto indices = geometry->indices();
+    const auto firstVertex = _vertices.size() / _vertexSize;
+    auto numVertices = 0u;
+
+    if (indices == nullptr || geometry->vertexBuffers().empty())
+        _failed = true;
+    else
+    {
+        numVertices = geometry->vertexBuffers().front()->numVertices();
+
+        if (firstVertex + numVertices > 65535)
+            _failed = true;
+    }
+
+    if (_failed)
+        return false;
+
+    _vertices.resize(_vertices.size() + numVertices * _vertexSize);
+
+    auto attributeOffset = 0u;
+
+    for (const auto& attribute : _attributes)
+    {
+        VertexBufferPtr vb;
+        auto offset = 0u;
+
+        if (!findAttribute(geometry, attribute, vb, offset) || vb->numVertices() != numVertices)
+        {
+            _failed = true;
+
+            return false;
+        }
+
+        const auto& data = vb->data();
+        const auto isPosition = attribute.name == "position";
+        const auto isDirection = attribute.name == "normal" || attribute.name == "tangent";
+
+        for (auto i = 0u; i < numVertices; ++i)
+        {
+            const auto* input = &data[i * vb->vertexSize() + offset];
+            auto* output = &_vertices[(firstVertex + i) * _vertexSize + attributeOffset];
+
+            if ((isPosition || isDirection) && attribute.size == 3)
+            {
+                _input->setTo(input[0], input[1], input[2]);
+
+                if (isPosition)
+                    matrix->transform(_input, _output);
+                else
+                    matrix->deltaTransform(_input, _output)->normalize();
+
+                output[0] = _output->x();
+                output[1] = _output->y();
+                output[2] = _output->z();
+            }
+            else
+                std::copy(input, input + attribute.size, output);
+        }
+
+        attributeOffset += attribute.size;
+    }
+
+    for (auto index : indices->data())
+        _indices.push_back(static_cast<unsigned short>(firstVertex + index));
+
+    return true;
+}
+
+geometry::Geometry::Ptr
+MeshMerger::build()
+{
+    if (_failed || _vertices.empty())
+        return nullptr;
+
+    auto vertexBuffer = render::VertexBuffer::create(_context, _vertices);
+    auto attributeOffset = 0u;
+
+    for (const auto& attribute : _attributes)
+    {
+        vertexBuffer->addAttribute(attribute.name, attribute.size, attributeOffset);
+        attributeOffset += attribute.size;
+    }
+
+    auto geometry = geometry::Geometry::create();
+
+    geometry->addVertexBuffer(vertexBuffer);
+    geometry->indices(render::IndexBuffer::create(_context, _indices));
+
+    return geometry;
+}
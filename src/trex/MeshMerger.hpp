@@ -0,0 +1,91 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+namespace trex
+{
+    // Bakes several geometries, each with its own model matrix, into a single
+    // interleaved geometry. Positions are transformed as points, normals and
+    // tangents as directions; every other attribute is copied as is.
+    class MeshMerger
+    {
+    public:
+        typedef std::shared_ptr<MeshMerger> Ptr;
+
+    private:
+        typedef std::shared_ptr<minko::render::VertexBuffer>    VertexBufferPtr;
+
+        struct Attribute
+        {
+            std::string     name;
+            unsigned int    size;
+        };
+
+    private:
+        minko::render::AbstractContext::Ptr _context;
+        std::vector<Attribute>              _attributes;
+        unsigned int                        _vertexSize;
+        std::vector<float>                  _vertices;
+        std::vector<unsigned short>         _indices;
+        bool                                _failed;
+        minko::math::Vector3::Ptr           _input;
+        minko::math::Vector3::Ptr           _output;
+
+    public:
+        static
+        Ptr
+        create(minko::render::AbstractContext::Ptr context)
+        {
+            return std::shared_ptr<MeshMerger>(new MeshMerger(context));
+        }
+
+        // Number of vertices added since the last reset(): the first vertex of the next
+        // geometry in the merged one.
+        inline
+        unsigned int
+        numVertices() const
+        {
+            return _vertexSize == 0 ? 0 : _vertices.size() / _vertexSize;
+        }
+
+        void
+        reset();
+
+        // Returns false, and fails the whole merge, if the geometry does not have the
+        // same vertex attributes as the previous ones or if 16 bit indices overflow.
+        bool
+        add(minko::geometry::Geometry::Ptr geometry, minko::math::Matrix4x4::Ptr matrix);
+
+        // Returns nullptr if nothing was added or if the merge failed.
+        minko::geometry::Geometry::Ptr
+        build();
+
+    private:
+        MeshMerger(minko::render::AbstractContext::Ptr context);
+
+        bool
+        findAttribute(minko::geometry::Geometry::Ptr    geometry,
+                      const Attribute&                  attribute,
+                      VertexBufferPtr&                  vertexBuffer,
+                      unsigned int&                     offset) const;
+    };
+}
@@ -0,0 +1,136 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ObstacleIndex.hpp"
+
+using namespace trex;
+
+ObstacleIndex::ObstacleIndex(unsigned int numChunks) :
+    _chunks(numChunks),
+    _rowToChunk(numChunks, -1)
+{
+    for (auto& chunk : _chunks)
+    {
+        chunk.row = 0;
+        chunk.z = 0.f;
+        chunk.placed = false;
+    }
+}
+
+void
+ObstacleIndex::clearChunk(int chunkId)
+{
+    auto& chunk = _chunks[chunkId];
+
+    chunk.obstacles.clear();
+
+    for (auto& cell : chunk.cells)
+        cell.clear();
+}
+
+void
+ObstacleIndex::addObstacle(int chunkId, minko::scene::Node::Ptr node, int lane, float x, float z, float width, float length)
+{
+    auto& chunk = _chunks[chunkId];
+    const auto obstacleId = int(chunk.obstacles.size());
+    const auto zMin = z - length / 2.f;
+    const auto zMax = z + length / 2.f;
+
+    chunk.obstacles.push_back({ node, lane, x - width / 2.f, x + width / 2.f, zMin, zMax });
+
+    auto firstCell = std::max(0, int(std::floor(zMin / TREX_OBSTACLE_CELL_LENGTH)));
+    auto lastCell = std::min(CELLS_PER_CHUNK - 1, int(std::floor(zMax / TREX_OBSTACLE_CELL_LENGTH)));
+
+    for (auto cell = firstCell; cell <= lastCell; ++cell)
+        chunk.cells[cell].push_back(obstacleId);
+}
+
+void
+ObstacleIndex::placeChunk(int chunkId, float z)
+{
+    removeChunk(chunkId);
+
+    auto& chunk = _chunks[chunkId];
+
+    chunk.row = row(z);
+    chunk.z = z;
+    chunk.placed = true;
+
+    _rowToChunk[rowSlot(chunk.row)] = chunkId;
+}
+
+void
+ObstacleIndex::removeChunk(int chunkId)
+{
+    auto& chunk = _chunks[chunkId];
+
+    if (!chunk.placed)
+        return;
+
+    if (_rowToChunk[rowSlot(chunk.row)] == chunkId)
+        _rowToChunk[rowSlot(chunk.row)] = -1;
+
+    chunk.placed = false;
+}
+
+const ObstacleIndex::Obstacle*
+ObstacleIndex::find(float xMin, float xMax, float zMin, float zMax, float afterZ, float& obstacleZ) const
+{
+    const Obstacle* nearest = nullptr;
+
+    for (auto zRow = row(zMin); zRow <= row(zMax); ++zRow)
+    {
+        auto chunkId = _rowToChunk[rowSlot(zRow)];
+
+        if (chunkId < 0 || _chunks[chunkId].row != zRow)
+            continue;
+
+        const auto& chunk = _chunks[chunkId];
+        const auto localZMin = std::max(0.f, zMin - chunk.z);
+        const auto localZMax = std::min(float(TREX_ROAD_CHUNK_LENGTH), zMax - chunk.z);
+
+        if (localZMax < localZMin)
+            continue;
+
+        const auto firstCell = std::min(CELLS_PER_CHUNK - 1, int(localZMin / TREX_OBSTACLE_CELL_LENGTH));
+        const auto lastCell = std::min(CELLS_PER_CHUNK - 1, int(localZMax / TREX_OBSTACLE_CELL_LENGTH));
+
+        for (auto cell = firstCell; cell <= lastCell; ++cell)
+        {
+            for (auto obstacleId : chunk.cells[cell])
+            {
+                const auto& obstacle = chunk.obstacles[obstacleId];
+                const auto obstacleFrontZ = chunk.z + obstacle.zMin;
+
+                if (obstacle.zMin > localZMax || obstacle.zMax < localZMin ||
+                    obstacle.xMin > xMax || obstacle.xMax < xMin ||
+                    obstacleFrontZ <= afterZ)
+                    continue;
+
+                if (nearest == nullptr || obstacleFrontZ < obstacleZ)
+                {
+                    nearest = &obstacle;
+                    obstacleZ = obstacleFrontZ;
+                }
+            }
+        }
+    }
+
+    return nearest;
+}
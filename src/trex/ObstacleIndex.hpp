@@ -0,0 +1,110 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    // Buckets the road obstacles of every pooled chunk by z-interval
+    // (TREX_OBSTACLE_CELL_LENGTH), in chunk space; the x overlap is tested per obstacle. Placing a chunk on the road only
+    // records which chunk occupies the corresponding row, so a lookup over a given
+    // world z-interval only visits the cells it covers, whatever the number of
+    // obstacles per chunk.
+    class ObstacleIndex
+    {
+    public:
+        typedef std::shared_ptr<ObstacleIndex>  Ptr;
+
+        struct Obstacle
+        {
+            minko::scene::Node::Ptr node;
+            int                     lane;
+            float                   xMin;
+            float                   xMax;
+            float                   zMin;
+            float                   zMax;
+        };
+
+    private:
+        static const int CELLS_PER_CHUNK = TREX_ROAD_CHUNK_LENGTH / TREX_OBSTACLE_CELL_LENGTH;
+
+        typedef std::array<std::vector<int>, CELLS_PER_CHUNK> Cells;
+
+        struct Chunk
+        {
+            std::vector<Obstacle>   obstacles;
+            Cells                   cells;
+            int                     row;
+            float                   z;
+            bool                    placed;
+        };
+
+    private:
+        std::vector<Chunk>  _chunks;
+        std::vector<int>    _rowToChunk;
+
+    public:
+        static
+        Ptr
+        create(unsigned int numChunks)
+        {
+            return std::shared_ptr<ObstacleIndex>(new ObstacleIndex(numChunks));
+        }
+
+        void
+        clearChunk(int chunkId);
+
+        void
+        addObstacle(int chunkId, minko::scene::Node::Ptr node, int lane, float x, float z, float width, float length);
+
+        void
+        placeChunk(int chunkId, float z);
+
+        void
+        removeChunk(int chunkId);
+
+        // Returns the nearest obstacle overlapping the [xMin, xMax] x [zMin, zMax] world box
+        // whose front is further than afterZ, and writes the world z of its front in obstacleZ.
+        const Obstacle*
+        find(float xMin, float xMax, float zMin, float zMax, float afterZ, float& obstacleZ) const;
+
+    private:
+        ObstacleIndex(unsigned int numChunks);
+
+        inline
+        int
+        row(float z) const
+        {
+            return int(std::floor(z / float(TREX_ROAD_CHUNK_LENGTH)));
+        }
+
+        inline
+        int
+        rowSlot(int row) const
+        {
+            const int numRows = int(_rowToChunk.size());
+
+            return ((row % numRows) + numRows) % numRows;
+        }
+    };
+}
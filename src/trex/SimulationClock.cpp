@@ -0,0 +1,52 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "SimulationClock.hpp"
+
+using namespace minko;
+using namespace minko::component;
+using namespace trex;
+
+void
+SimulationClock::animationTimeScale(float animationTimeScale)
+{
+    _animationTimeOrigin = animationTime(_time);
+    _animationTimeAnchor = _time;
+    _animationTimeScale = animationTimeScale;
+}
+
+void
+SimulationClock::frame(SceneManagerPtr sceneManager, float realDeltaTime)
+{
+    advance(sceneManager, realDeltaTime * _timeScale);
+}
+
+void
+SimulationClock::step(SceneManagerPtr sceneManager)
+{
+    advance(sceneManager, _fixedStep * _timeScale);
+}
+
+void
+SimulationClock::advance(SceneManagerPtr sceneManager, float deltaTime)
+{
+    _time += deltaTime;
+
+    sceneManager->nextFrame(float(_time), deltaTime);
+}
@@ -0,0 +1,120 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    // The clock every script, animation and timeline of the scene runs on: the scene is only
+    // ever advanced through it, so time() and deltaTime() seen by the scripts are scaled
+    // game time. A frame of the game advances by the scaled real frame duration; trex-sim
+    // fast-forwards by fixed steps, regardless of the real time. On top of the game time,
+    // animations can run on their own, further scaled, animation time.
+    class SimulationClock
+    {
+    public:
+        typedef std::shared_ptr<SimulationClock>    Ptr;
+
+    private:
+        typedef std::shared_ptr<minko::component::SceneManager> SceneManagerPtr;
+
+    private:
+        // accumulated in double: a float in ms only keeps whole ms past 2^23 ms (~2.3 h)
+        double          _time;
+        float           _timeScale;
+        float           _animationTimeScale;
+        double          _animationTimeAnchor;
+        double          _animationTimeOrigin;
+        float           _fixedStep;
+
+    public:
+        static
+        Ptr
+        create(float fixedStep = TREX_SIM_TIME_STEP)
+        {
+            return std::shared_ptr<SimulationClock>(new SimulationClock(fixedStep));
+        }
+
+        // Game time, in ms.
+        inline
+        double
+        time() const
+        {
+            return _time;
+        }
+
+        inline
+        float
+        timeScale() const
+        {
+            return _timeScale;
+        }
+
+        inline
+        void
+        timeScale(float timeScale)
+        {
+            _timeScale = timeScale;
+        }
+
+        inline
+        float
+        animationTimeScale() const
+        {
+            return _animationTimeScale;
+        }
+
+        // Scales the animation time from now on, relative to the game time.
+        void
+        animationTimeScale(float animationTimeScale);
+
+        // Maps a game time from the last animation time scale change to an animation time.
+        inline
+        double
+        animationTime(double time) const
+        {
+            return _animationTimeOrigin + (time - _animationTimeAnchor) * _animationTimeScale;
+        }
+
+        void
+        frame(SceneManagerPtr sceneManager, float realDeltaTime);
+
+        // Advances by one fixed step; every step renders the scene when it has a context.
+        void
+        step(SceneManagerPtr sceneManager);
+
+    private:
+        SimulationClock(float fixedStep) :
+            _time(0.0),
+            _timeScale(1.f),
+            _animationTimeScale(1.f),
+            _animationTimeAnchor(0.0),
+            _animationTimeOrigin(0.0),
+            _fixedStep(fixedStep)
+        {
+        }
+
+        void
+        advance(SceneManagerPtr sceneManager, float deltaTime);
+    };
+}
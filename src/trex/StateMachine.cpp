@@ -0,0 +1,251 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "minko/log/Logger.hpp"
+
+#include "StateMachine.hpp"
+
+#include "json/json.h"
+
+using namespace trex;
+
+StateMachine::StateMachine(unsigned int numStates, unsigned int numTimers, int stateTimer, int initialState) :
+    _states(numStates),
+    _timers(numTimers, 0.f),
+    _stateTimer(stateTimer),
+    _current(initialState),
+    _changed(minko::Signal<int, int>::create())
+{
+}
+
+void
+StateMachine::nameState(int state, const std::string& name)
+{
+    _stateNames[name] = state;
+}
+
+void
+StateMachine::nameCondition(int condition, const std::string& name)
+{
+    _conditionNames[name] = condition;
+}
+
+void
+StateMachine::nameAction(int action, const std::string& name)
+{
+    _actionNames[name] = action;
+}
+
+void
+StateMachine::nameTimer(int timer, const std::string& name)
+{
+    _timerNames[name] = timer;
+}
+
+void
+StateMachine::nameEvent(int event, const std::string& name)
+{
+    _eventNames[name] = event;
+}
+
+void
+StateMachine::addEnterAction(int state, const Action& action)
+{
+    _states[state].enter.push_back(action);
+}
+
+void
+StateMachine::addExitAction(int state, const Action& action)
+{
+    _states[state].exit.push_back(action);
+}
+
+void
+StateMachine::addTransition(int from, const Transition& transition)
+{
+    _states[from].transitions.push_back(transition);
+}
+
+static
+bool
+findName(const std::map<std::string, int>& names, const Json::Value& value, int& id)
+{
+    auto it = names.find(value.asString());
+
+    if (it == names.end())
+    {
+        LOG_ERROR("unknown state machine name: " + value.asString());
+
+        return false;
+    }
+
+    id = it->second;
+
+    return true;
+}
+
+bool
+StateMachine::load(const std::string& json)
+{
+    Json::Value root;
+    Json::Reader reader;
+
+    if (!reader.parse(json, root) || !root.isObject() || !root["states"].isObject())
+    {
+        LOG_ERROR("invalid state machine table: " + reader.getFormattedErrorMessages());
+
+        return false;
+    }
+
+    std::vector<State> states(_states.size());
+    const auto& statesValue = root["states"];
+
+    auto parseActions = [&](const Json::Value& actionsValue, std::vector<Action>& actions)
+    {
+        for (Json::Value::ArrayIndex i = 0; i < actionsValue.size(); ++i)
+        {
+            const auto& actionValue = actionsValue[i];
+            Action action = { 0, 0, actionValue.get("value", 0.f).asFloat(), actionValue.get("start", "").asString(), actionValue.get("stop", "").asString() };
+
+            if (!findName(_actionNames, actionValue["action"], action.action))
+                return false;
+            if (actionValue.isMember("timer") && !findName(_timerNames, actionValue["timer"], action.timer))
+                return false;
+
+            actions.push_back(action);
+        }
+
+        return true;
+    };
+
+    for (const auto& stateName : statesValue.getMemberNames())
+    {
+        const auto& stateValue = statesValue[stateName];
+        auto stateId = 0;
+
+        if (!findName(_stateNames, Json::Value(stateName), stateId))
+            return false;
+
+        auto& state = states[stateId];
+
+        if (!parseActions(stateValue["enter"], state.enter) || !parseActions(stateValue["exit"], state.exit))
+            return false;
+
+        const auto& transitionsValue = stateValue["transitions"];
+
+        for (Json::Value::ArrayIndex i = 0; i < transitionsValue.size(); ++i)
+        {
+            const auto& transitionValue = transitionsValue[i];
+            Transition transition = { 0, NO_EVENT, std::vector<Guard>() };
+
+            if (!findName(_stateNames, transitionValue["to"], transition.to))
+                return false;
+            if (transitionValue.isMember("event") && !findName(_eventNames, transitionValue["event"], transition.event))
+                return false;
+
+            const auto& guardsValue = transitionValue["guards"];
+
+            for (Json::Value::ArrayIndex j = 0; j < guardsValue.size(); ++j)
+            {
+                const auto& guardValue = guardsValue[j];
+                Guard guard = { 0, guardValue.get("not", false).asBool(), 0, guardValue.get("value", 0.f).asFloat() };
+
+                if (!findName(_conditionNames, guardValue["condition"], guard.condition))
+                    return false;
+                if (guardValue.isMember("timer") && !findName(_timerNames, guardValue["timer"], guard.timer))
+                    return false;
+
+                transition.guards.push_back(guard);
+            }
+
+            state.transitions.push_back(transition);
+        }
+    }
+
+    _states.swap(states);
+
+    return true;
+}
+
+bool
+StateMachine::guardsPass(const Transition& transition) const
+{
+    for (const auto& guard : transition.guards)
+        if (_condition(guard) == guard.negate)
+            return false;
+
+    return true;
+}
+
+void
+StateMachine::runActions(const std::vector<Action>& actions)
+{
+    for (const auto& action : actions)
+        _action(action);
+}
+
+void
+StateMachine::change(int state)
+{
+    if (state == _current)
+        return;
+
+    auto previous = _current;
+
+    runActions(_states[_current].exit);
+
+    _current = state;
+
+    runActions(_states[_current].enter);
+
+    resetTimer(_stateTimer);
+
+    _changed->execute(previous, _current);
+}
+
+void
+StateMachine::update(float deltaTime)
+{
+    for (auto& timer : _timers)
+        timer += deltaTime;
+
+    for (const auto& transition : _states[_current].transitions)
+    {
+        if (transition.event == NO_EVENT && guardsPass(transition))
+        {
+            change(transition.to);
+
+            return;
+        }
+    }
+}
+
+void
+StateMachine::trigger(int event)
+{
+    for (const auto& transition : _states[_current].transitions)
+    {
+        if (transition.event == event && guardsPass(transition))
+        {
+            change(transition.to);
+
+            return;
+        }
+    }
+}
@@ -0,0 +1,201 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+namespace trex
+{
+    // A state machine whose states, transitions, guards, timers and enter/exit actions are
+    // declared in a table, either in code or from JSON. The owner names its states, guard
+    // conditions, actions, timers and events; it then evaluates conditions and runs actions
+    // by id, so that a tick only reads arrays.
+    //
+    // JSON table:
+    // { "states": { "<state>": {
+    //     "enter": [ { "action": "<action>", "value": 1.0, "timer": "<timer>", "start": "<label>", "stop": "<label>" } ],
+    //     "exit": [ ... ],
+    //     "transitions": [ { "to": "<state>", "event": "<event>",
+    //         "guards": [ { "condition": "<condition>", "not": false, "value": 1.0, "timer": "<timer>" } ] } ]
+    // } } }
+    // Transitions without an event are checked on every update(), the others when their
+    // event is triggered; the first one whose guards all pass is taken.
+    class StateMachine
+    {
+    public:
+        typedef std::shared_ptr<StateMachine>   Ptr;
+
+        static const int NO_EVENT = -1;
+
+        struct Guard
+        {
+            int     condition;
+            bool    negate;
+            int     timer;
+            float   value;
+        };
+
+        struct Action
+        {
+            int         action;
+            int         timer;
+            float       value;
+            std::string startLabel;
+            std::string stopLabel;
+        };
+
+        struct Transition
+        {
+            int                 to;
+            int                 event;
+            std::vector<Guard>  guards;
+        };
+
+        typedef std::function<bool(const Guard&)>   ConditionFunction;
+        typedef std::function<void(const Action&)>  ActionFunction;
+
+    private:
+        struct State
+        {
+            std::vector<Action>     enter;
+            std::vector<Action>     exit;
+            std::vector<Transition> transitions;
+        };
+
+        typedef std::map<std::string, int>  Names;
+
+    private:
+        std::vector<State>              _states;
+        std::vector<float>              _timers;
+        int                             _stateTimer;
+        int                             _current;
+        ConditionFunction               _condition;
+        ActionFunction                  _action;
+        minko::Signal<int, int>::Ptr    _changed;
+
+        Names                           _stateNames;
+        Names                           _conditionNames;
+        Names                           _actionNames;
+        Names                           _timerNames;
+        Names                           _eventNames;
+
+    public:
+        // stateTimer is reset on every state change.
+        static
+        Ptr
+        create(unsigned int numStates, unsigned int numTimers, int stateTimer, int initialState)
+        {
+            return std::shared_ptr<StateMachine>(new StateMachine(numStates, numTimers, stateTimer, initialState));
+        }
+
+        inline
+        void
+        conditionFunction(const ConditionFunction& function)
+        {
+            _condition = function;
+        }
+
+        inline
+        void
+        actionFunction(const ActionFunction& function)
+        {
+            _action = function;
+        }
+
+        inline
+        int
+        current() const
+        {
+            return _current;
+        }
+
+        // Executed with the previous and the new state, once the enter actions have run.
+        inline
+        minko::Signal<int, int>::Ptr
+        changed() const
+        {
+            return _changed;
+        }
+
+        inline
+        float
+        timer(int timer) const
+        {
+            return _timers[timer];
+        }
+
+        inline
+        void
+        resetTimer(int timer)
+        {
+            _timers[timer] = 0.f;
+        }
+
+        // Names used by the JSON tables.
+        void
+        nameState(int state, const std::string& name);
+
+        void
+        nameCondition(int condition, const std::string& name);
+
+        void
+        nameAction(int action, const std::string& name);
+
+        void
+        nameTimer(int timer, const std::string& name);
+
+        void
+        nameEvent(int event, const std::string& name);
+
+        void
+        addEnterAction(int state, const Action& action);
+
+        void
+        addExitAction(int state, const Action& action);
+
+        void
+        addTransition(int from, const Transition& transition);
+
+        // Replaces the whole table. Returns false, keeping the current table, if the JSON
+        // cannot be parsed or uses an unknown name.
+        bool
+        load(const std::string& json);
+
+        void
+        change(int state);
+
+        // Advances the timers by deltaTime seconds and takes the first passing transition
+        // without event of the current state.
+        void
+        update(float deltaTime);
+
+        void
+        trigger(int event);
+
+    private:
+        StateMachine(unsigned int numStates, unsigned int numTimers, int stateTimer, int initialState);
+
+        bool
+        guardsPass(const Transition& transition) const;
+
+        void
+        runActions(const std::vector<Action>& actions);
+    };
+}
@@ -0,0 +1,207 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "VoicePool.hpp"
+
+using namespace minko;
+using namespace minko::audio;
+using namespace minko::component;
+using namespace trex;
+
+VoicePool::VoicePool(NodePtr camera, unsigned int numVoices) :
+    _voices(numVoices),
+    _camera(camera),
+    _audibility([](float) { return 1.f; }),
+    _threshold(0.f),
+    _numVirtualized(0),
+    _frame(0)
+{
+    for (auto& voice : _voices)
+    {
+        voice.transform = SoundTransform::create();
+        voice.priority = 0;
+        voice.startFrame = 0;
+    }
+}
+
+VoicePool::AudibilityFunction
+VoicePool::inverseDistance(float referenceDistance, float maxDistance, float rolloff)
+{
+    return [=](float distance)
+    {
+        if (distance > maxDistance)
+            return 0.f;
+
+        distance = std::max(distance, referenceDistance);
+
+        return referenceDistance / (referenceDistance + rolloff * (distance - referenceDistance));
+    };
+}
+
+void
+VoicePool::initialize(SceneManagerPtr sceneManager)
+{
+    _frameBeginSlot = sceneManager->frameBegin()->connect([&](SceneManager::Ptr, float, float)
+    {
+        update();
+    });
+}
+
+bool
+VoicePool::play(SoundPtr sound, NodePtr emitter, int priority)
+{
+    auto voiceGain = gain(emitter);
+
+    if (voiceGain < _threshold)
+    {
+        ++_numVirtualized;
+
+        return false;
+    }
+
+    Voice* target = nullptr;
+
+    for (auto& voice : _voices)
+    {
+        if (voice.channel == nullptr)
+        {
+            target = &voice;
+            break;
+        }
+
+        if (target == nullptr ||
+            voice.priority < target->priority ||
+            (voice.priority == target->priority && voice.startFrame < target->startFrame))
+            target = &voice;
+    }
+
+    if (target == nullptr || (target->channel != nullptr && target->priority > priority))
+        return false;
+
+    release(*target);
+
+    auto channel = sound->play(1);
+
+    if (!channel)
+        return false;
+
+    target->channel = channel;
+    target->emitter = emitter;
+    target->priority = priority;
+    target->startFrame = _frame;
+
+    spatialize(*target, voiceGain);
+
+    return true;
+}
+
+unsigned int
+VoicePool::numPlaying() const
+{
+    unsigned int numPlaying = 0;
+
+    for (const auto& voice : _voices)
+        if (voice.channel != nullptr)
+            ++numPlaying;
+
+    return numPlaying;
+}
+
+void
+VoicePool::stopAll()
+{
+    for (auto& voice : _voices)
+        release(voice);
+}
+
+void
+VoicePool::update()
+{
+    ++_frame;
+
+    for (auto& voice : _voices)
+    {
+        if (voice.channel == nullptr)
+            continue;
+
+        if (!voice.channel->playing())
+        {
+            release(voice);
+
+            continue;
+        }
+
+        auto voiceGain = gain(voice.emitter);
+
+        if (voiceGain < _threshold)
+        {
+            ++_numVirtualized;
+            release(voice);
+        }
+        else
+            spatialize(voice, voiceGain);
+    }
+}
+
+float
+VoicePool::gain(NodePtr emitter) const
+{
+    const auto& camera = _camera->component<Transform>()->modelToWorldMatrix()->data();
+    const auto& position = emitter->component<Transform>()->modelToWorldMatrix()->data();
+
+    auto dx = position[3] - camera[3];
+    auto dy = position[7] - camera[7];
+    auto dz = position[11] - camera[11];
+
+    return _audibility(std::sqrt(dx * dx + dy * dy + dz * dz));
+}
+
+void
+VoicePool::spatialize(Voice& voice, float gain)
+{
+    // both matrices are row-major: the translation is in the last column and the camera
+    // right axis in the first one
+    const auto& camera = _camera->component<Transform>()->modelToWorldMatrix()->data();
+    const auto& emitter = voice.emitter->component<Transform>()->modelToWorldMatrix()->data();
+
+    auto dx = emitter[3] - camera[3];
+    auto dy = emitter[7] - camera[7];
+    auto dz = emitter[11] - camera[11];
+    auto distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+    auto right = std::sqrt(camera[0] * camera[0] + camera[4] * camera[4] + camera[8] * camera[8]);
+    auto pan = distance > 0.f && right > 0.f
+        ? (dx * camera[0] + dy * camera[4] + dz * camera[8]) / (distance * right)
+        : 0.f;
+
+    voice.transform->volume(gain);
+    voice.transform->left(std::min(1.f, 1.f - pan));
+    voice.transform->right(std::min(1.f, 1.f + pan));
+
+    voice.channel->transform(voice.transform);
+}
+
+void
+VoicePool::release(Voice& voice)
+{
+    if (voice.channel != nullptr && voice.channel->playing())
+        voice.channel->stop();
+
+    voice.channel = nullptr;
+    voice.emitter = nullptr;
+}
@@ -0,0 +1,132 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+namespace trex
+{
+    // A fixed set of voices for positional one-shot sounds. Every voice owns its sound
+    // transform and is spatialized once per frame against the camera. When all the voices
+    // are busy, a new sound steals the lowest priority voice (the oldest one on a tie) unless
+    // that voice has a higher priority than the new sound, in which case the new sound is dropped.
+    // Voices whose gain falls under the audibility threshold are virtualized: the engine can
+    // neither pause a channel nor seek into a sound, so an inaudible one-shot is not started
+    // and a voice becoming inaudible is stopped, freeing its mixer channel.
+    class VoicePool
+    {
+    public:
+        typedef std::shared_ptr<VoicePool>                  Ptr;
+        typedef std::function<float(float)>                 AudibilityFunction;
+
+    private:
+        typedef std::shared_ptr<minko::scene::Node>             NodePtr;
+        typedef std::shared_ptr<minko::audio::Sound>            SoundPtr;
+        typedef std::shared_ptr<minko::audio::SoundChannel>     SoundChannelPtr;
+        typedef std::shared_ptr<minko::audio::SoundTransform>   SoundTransformPtr;
+        typedef std::shared_ptr<minko::component::SceneManager> SceneManagerPtr;
+        typedef minko::Signal<SceneManagerPtr, float, float>::Slot  FrameSlot;
+
+        struct Voice
+        {
+            SoundChannelPtr     channel;
+            SoundTransformPtr   transform;
+            NodePtr             emitter;
+            int                 priority;
+            minko::uint         startFrame;
+        };
+
+    private:
+        std::vector<Voice>      _voices;
+        NodePtr                 _camera;
+        AudibilityFunction      _audibility;
+        float                   _threshold;
+        unsigned int            _numVirtualized;
+        minko::uint             _frame;
+        FrameSlot               _frameBeginSlot;
+
+    public:
+        static
+        Ptr
+        create(SceneManagerPtr sceneManager, NodePtr camera, unsigned int numVoices)
+        {
+            auto pool = std::shared_ptr<VoicePool>(new VoicePool(camera, numVoices));
+
+            pool->initialize(sceneManager);
+
+            return pool;
+        }
+
+        // Inverse distance attenuation, full gain up to referenceDistance and silent beyond
+        // maxDistance.
+        static
+        AudibilityFunction
+        inverseDistance(float referenceDistance, float maxDistance, float rolloff);
+
+        inline
+        void
+        audibilityCurve(const AudibilityFunction& audibility)
+        {
+            _audibility = audibility;
+        }
+
+        inline
+        void
+        audibilityThreshold(float threshold)
+        {
+            _threshold = threshold;
+        }
+
+        inline
+        unsigned int
+        numVirtualized() const
+        {
+            return _numVirtualized;
+        }
+
+        // Returns false when the sound was dropped.
+        bool
+        play(SoundPtr sound, NodePtr emitter, int priority);
+
+        unsigned int
+        numPlaying() const;
+
+        void
+        stopAll();
+
+    private:
+        VoicePool(NodePtr camera, unsigned int numVoices);
+
+        void
+        initialize(SceneManagerPtr sceneManager);
+
+        void
+        update();
+
+        float
+        gain(NodePtr emitter) const;
+
+        void
+        spatialize(Voice& voice, float gain);
+
+        void
+        release(Voice& voice);
+    };
+}
@@ -0,0 +1,91 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "WorldCache.hpp"
+
+using namespace minko;
+using namespace minko::component;
+using namespace trex;
+
+WorldCache::WorldCache() :
+    _nodes(CAR + 1, nullptr),
+    _positions(CAR + 1, WorldPosition { 0.f, 0.f, 0.f }),
+    _resolvedFrames(CAR + 1, 0),
+    _frame(1)
+{
+}
+
+void
+WorldCache::sceneManager(SceneManagerPtr sceneManager)
+{
+    _frameBeginSlot = sceneManager->frameBegin()->connect([&](SceneManager::Ptr, float, float)
+    {
+        invalidate();
+    });
+}
+
+void
+WorldCache::track(Slot slot, scene::Node::Ptr node)
+{
+    _nodes[slot] = node;
+    _resolvedFrames[slot] = 0;
+}
+
+WorldCache::Slot
+WorldCache::track(scene::Node::Ptr node)
+{
+    _nodes.push_back(node);
+    _positions.push_back({ 0.f, 0.f, 0.f });
+    _resolvedFrames.push_back(0);
+
+    return _nodes.size() - 1;
+}
+
+const WorldPosition&
+WorldCache::position(Slot slot)
+{
+    auto& position = _positions[slot];
+
+    if (_resolvedFrames[slot] != _frame && _nodes[slot] != nullptr)
+    {
+        // row-major: the translation is in the last column
+        const auto& matrix = _nodes[slot]->component<Transform>()->modelToWorldMatrix(true)->data();
+
+        position.x = matrix[3];
+        position.y = matrix[7];
+        position.z = matrix[11];
+
+        _resolvedFrames[slot] = _frame;
+    }
+
+    return position;
+}
+
+float
+WorldCache::distance(Slot a, Slot b)
+{
+    const auto& positionA = position(a);
+    const auto& positionB = position(b);
+
+    auto dx = positionA.x - positionB.x;
+    auto dy = positionA.y - positionB.y;
+    auto dz = positionA.z - positionB.z;
+
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
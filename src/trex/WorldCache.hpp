@@ -0,0 +1,100 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+namespace trex
+{
+    struct WorldPosition
+    {
+        float x;
+        float y;
+        float z;
+    };
+
+    // World positions of the few nodes every script looks at. A position is resolved from
+    // the node world matrix on its first read in a frame and then read back as a plain
+    // value, without walking the matrices again nor allocating vectors.
+    class WorldCache
+    {
+    public:
+        typedef std::shared_ptr<WorldCache>     Ptr;
+        typedef minko::uint                     Slot;
+
+        // the slot of the car, known to every script
+        static const Slot CAR = 0;
+
+    private:
+        typedef std::shared_ptr<minko::component::SceneManager>     SceneManagerPtr;
+        typedef minko::Signal<SceneManagerPtr, float, float>::Slot  FrameSlot;
+
+    private:
+        std::vector<minko::scene::Node::Ptr>            _nodes;
+        std::vector<WorldPosition>                      _positions;
+        std::vector<minko::uint>                        _resolvedFrames;
+        minko::uint                                     _frame;
+        FrameSlot                                       _frameBeginSlot;
+
+    public:
+        static
+        Ptr
+        create()
+        {
+            return std::shared_ptr<WorldCache>(new WorldCache());
+        }
+
+        // Starts a new frame on every frameBegin of the scene.
+        void
+        sceneManager(SceneManagerPtr sceneManager);
+
+        void
+        track(Slot slot, minko::scene::Node::Ptr node);
+
+        // Tracks a node in a new slot, returned as the handle to read it back.
+        Slot
+        track(minko::scene::Node::Ptr node);
+
+        const WorldPosition&
+        position(Slot slot);
+
+        float
+        distance(Slot a, Slot b);
+
+        // To be called when tracked nodes moved within the frame, e.g. on an origin shift.
+        inline
+        void
+        invalidate()
+        {
+            ++_frame;
+        }
+
+        // To be called when the node of a slot moved after the position may have been read.
+        inline
+        void
+        invalidate(Slot slot)
+        {
+            _resolvedFrames[slot] = 0;
+        }
+
+    private:
+        WorldCache();
+    };
+}
@@ -19,7 +19,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 
 #include "trex/Config.hpp"
 #include "CarScript.hpp"
-#include "minko/MinkoOculus.hpp"
+#ifndef TREX_HEADLESS
+# include "minko/MinkoOculus.hpp"
+#endif
 #include "minko/component/Renderer.hpp"
 #include "minko/scene/Node.hpp"
 #include "trex/Config.hpp"
@@ -37,22 +39,17 @@ using namespace minko::input;
 using namespace minko::animation;
 using namespace trex::component;
 
-CarScript::CarScript(Canvas::Ptr canvas, NodePtr root) :
+CarScript::CarScript(Canvas::Ptr canvas, NodePtr root, SimulationClock::Ptr clock) :
     _target(nullptr),
     _sceneManager(nullptr),
     _speed(0.0f),
+    _distance(0.0),
+    _originShifted(Signal<float>::create()),
     _lane((NUM_LANES - 1) / 2),
     _canvas(canvas),
-    _leftDown(false),
-    _rightDown(false),
-    _leftCameraDown(false),
-    _rightCameraDown(false),
-    _cameraVAngle(0.f),
-    _joystick(nullptr),
-    _joyLX(0.f),
-    _joyLY(0.f),
-    _joyRX(0.f),
-    _joyRY(0.f),
+    _cameraYaw(0.f),
+    _cameraPitch(0.f),
+    _cameraBaseMatrix(Matrix4x4::create()),
     _root(root),
     _lockedLane(-1),
     _obstacleHitCount(0),
@@ -61,7 +58,8 @@ CarScript::CarScript(Canvas::Ptr canvas, NodePtr root) :
     _oculusDetected(false),
     _currentScreen("texture/firstscreen.png"),
     _screenQuad(nullptr),
-    _eating(false)
+    _eating(false),
+    _clock(clock)
 {
 }
 
@@ -72,49 +70,16 @@ CarScript::initialize()
 
     _screenQuad = scene::Node::create();
 
-    initJoysticks();
+#ifndef TREX_HEADLESS
+    _input = InputMapper::create(_canvas);
+#endif
+#ifdef TREX_ENABLE_LATENCY_PROBE
+    _latencyProbe = LatencyProbe::create();
+#endif
+    _world = WorldCache::create();
     initCarLaneAnimations();
 }
 
-void
-CarScript::initJoysticks()
-{
-    _joystickAdded = _canvas->joystickAdded()->connect([&](AbstractCanvas::Ptr abscanvas, input::Joystick::Ptr joystick)
-    {
-        if (_joystick != nullptr)
-            return;
-
-        _joystick = joystick;
-
-        _joystickAxisMotion = _joystick->joystickAxisMotion()->connect([&](JoystickPtr joystick, int which, int axis, int value)
-        {
-            auto v = (float)(value) / 33000.f;
-
-            if (axis == AXIS_LX)
-                _joyLX = v;
-            if (axis == AXIS_LY)
-                _joyLY = v;
-
-            if (axis == AXIS_RX)
-                _joyRX = v;
-            if (axis == AXIS_RY)
-                _joyRY = v;
-        });
-        
-        _joystickButtonDown = _joystick->joystickButtonDown()->connect([&](JoystickPtr joystick, int which, int button)
-        {
-            if (button == (int)Joystick::Button::A || button == (int)Joystick::Button::Start)
-                startGame();
-        });
-    });
-
-    _joystickRemoved = _canvas->joystickRemoved()->connect([&](AbstractCanvas::Ptr canvas, JoystickPtr joystick)
-    {
-        if (_joystick == joystick)
-            _joystick = nullptr;
-    });
-}
-
 void
 CarScript::lockLane(int laneId, bool locked)
 {
@@ -136,13 +101,33 @@ CarScript::start(scene::Node::Ptr target)
 
     _sceneManager = _target->root()->component<SceneManager>();
 
+    _world->sceneManager(_sceneManager);
+    _world->track(WorldCache::CAR, _target);
+
+#ifdef TREX_ENABLE_LATENCY_PROBE
+    // this slot may run after update() in the same frameBegin: only the lane changes of
+    // the previous frames, already presented, are completed
+    _frameBeginSlot = _sceneManager->frameBegin()->connect([&](SceneManager::Ptr sceneManager, float, float)
+    {
+        _latencyProbe->framePresented(sceneManager->frameId(), InputMapper::now());
+    });
+#endif
+
     if (TREX_ENABLE_PARTICLES)
         initParticles();
 
     initCarSymbol();
     initCamera();
 
-#ifdef CAR_SCORE_ENABLE
+#ifndef TREX_HEADLESS
+    _voices = VoicePool::create(_sceneManager, _camera, TREX_NUM_VOICES);
+    _voices->audibilityCurve(VoicePool::inverseDistance(
+        TREX_SOUND_REFERENCE_DISTANCE, TREX_SOUND_MAX_DISTANCE, TREX_SOUND_ROLLOFF
+    ));
+    _voices->audibilityThreshold(TREX_SOUND_AUDIBILITY_THRESHOLD);
+#endif
+
+#if defined(CAR_SCORE_ENABLE) && !defined(TREX_HEADLESS)
     initScore();
 #endif
 
@@ -172,7 +157,9 @@ CarScript::initScore()
     {
         return n->hasComponent<Surface>();
     });
-    
+    std::vector<NodePtr> digitNodes(5);
+    std::vector<NodePtr> kmDigitNodes(2);
+
     for (auto node : digits->nodes())
     {
         auto basicMaterial = std::static_pointer_cast<minko::material::BasicMaterial>(node->component<Surface>()->material());
@@ -180,23 +167,31 @@ CarScript::initScore()
         node->component<Surface>()->effect(_sceneManager->assets()->effect("effect/Basic.effect"));
 
         if (node->name() == "digit_5")
-            _digitNodes[4] = node;
+            digitNodes[4] = node;
         else if (node->name() == "digit_4")
-            _digitNodes[3] = node;
+            digitNodes[3] = node;
         else if (node->name() == "digit_3")
-            _digitNodes[2] = node;
+            digitNodes[2] = node;
         else if (node->name() == "digit_2")
-            _digitNodes[1] = node;
+            digitNodes[1] = node;
         else if (node->name() == "digit_1")
-            _digitNodes[0] = node;
+            digitNodes[0] = node;
 
         else if (node->name() == "km_digit_1")
-            _kmDigitNodes[0] = node;
+            kmDigitNodes[0] = node;
         else if (node->name() == "km_digit_2")
-            _kmDigitNodes[1] = node;
+            kmDigitNodes[1] = node;
 
     }
 
+    _scoreBoard = ScoreBoard::create();
+    _scoreCounter = _scoreBoard->addCounter(digitNodes, 0.f);
+    _kmCounter = _scoreBoard->addCounter(kmDigitNodes, 0.5f);
+    digitBoard->addComponent(_scoreBoard);
+
+#ifdef CAR_SCORE_SINGLE_DRAW
+    _scoreBoard->merge(_sceneManager->assets()->context(), _sceneManager->assets()->effect("effect/Basic.effect"));
+#endif
 
     digitDummyNodeParent->addChild(digitBoard);
 
@@ -212,7 +207,11 @@ CarScript::initParticles()
 void
 CarScript::initCarSymbol()
 {
+#ifdef TREX_HEADLESS
+    _carSymbol = scene::Node::create("vehicle_jeep");
+#else
     _carSymbol = _sceneManager->assets()->symbol("model/vehicle_jeep.scene");
+#endif
 
     if (!_carSymbol->hasComponent<Transform>())
         _carSymbol->addComponent(Transform::create());
@@ -221,8 +220,6 @@ CarScript::initCarSymbol()
 
     _carAnimatedNode->addChild(_carSymbol);
     _target->addChild(_carAnimatedNode);
-
-    _carLaneAnimation->seek(0)->stop();
 }
 
 void
@@ -231,62 +228,18 @@ CarScript::initCarLaneAnimations()
     _carAnimatedNode = Node::create();
     _carAnimatedNode->addComponent(Transform::create());
 
-    auto lane0 = Matrix4x4::create()->appendTranslation(LANE_WIDTH, 0.f, 0.f);
-    auto lane1 = Matrix4x4::create();
-    auto lane2 = Matrix4x4::create()->appendTranslation(-LANE_WIDTH, 0.f, 0.f);
-
-    auto lane0to1 = Matrix4x4::create()->prependRotationY(float(-M_PI_4) / 5.5f)->appendTranslation(LANE_WIDTH / 2, 0.f, 0.f);
-    auto lane1to0 = Matrix4x4::create()->prependRotationY(float(M_PI_4) / 5.5f)->appendTranslation(LANE_WIDTH / 2, 0.f, 0.f);
-
-    auto lane1to2 = Matrix4x4::create()->prependRotationY(float(-M_PI_4) / 5.5f)->appendTranslation(-LANE_WIDTH / 2, 0.f, 0.f);
-    auto lane2to1 = Matrix4x4::create()->prependRotationY(float(M_PI_4) / 5.5f)->appendTranslation(-LANE_WIDTH / 2, 0.f, 0.f);
-
-    std::vector<Matrix4x4::Ptr> matrices = { lane1, lane1to0, lane0, lane0to1, lane1, lane1to2, lane2, lane2to1, lane1};
-    std::vector<uint> timetable;
-
-    for (int i = 0; i < 9; ++i)
+    _laneMotion = LaneMotion::create(_lane);
+    _laneMotionEvent = _laneMotion->event()->connect([&](LaneMotion::Ptr, LaneMotion::Event event, int lane)
     {
-        timetable.push_back(i * LANE_CHANGE_DURATION / 2);
-    }
-
-    auto timeline = animation::Matrix4x4Timeline::create("transform.matrix", 3000, timetable, matrices, true);
-    _carLaneAnimation = Animation::create({ timeline });
-
-    auto halfDuration = static_cast<unsigned int>(LANE_CHANGE_DURATION * 0.5f);
-
-    _carLaneAnimation->addLabel("1to0_start", 0);
-    _carLaneAnimation->addLabel("1to0", halfDuration);
-    _carLaneAnimation->addLabel("1to0_end", LANE_CHANGE_DURATION);
-
-    _carLaneAnimation->addLabel("0to1_start", LANE_CHANGE_DURATION);
-    _carLaneAnimation->addLabel("0to1", LANE_CHANGE_DURATION + halfDuration);
-    _carLaneAnimation->addLabel("0to1_end", LANE_CHANGE_DURATION * 2);
-
-    _carLaneAnimation->addLabel("1to2_start", LANE_CHANGE_DURATION * 2);
-    _carLaneAnimation->addLabel("1to2", LANE_CHANGE_DURATION * 2 + halfDuration);
-    _carLaneAnimation->addLabel("1to2_end", LANE_CHANGE_DURATION * 3);
+        if (event != LaneMotion::Event::ENTERED)
+            return;
 
-    _carLaneAnimation->addLabel("2to1_start", LANE_CHANGE_DURATION * 3);
-    _carLaneAnimation->addLabel("2to1", LANE_CHANGE_DURATION * 3 + halfDuration);
-    _carLaneAnimation->addLabel("2to1_end", LANE_CHANGE_DURATION * 4);
-    
-    _carLaneAnimation->isLooping(false);
+        _lane = lane;
 
-    _carLaneAnimationLabelHit = _carLaneAnimation->labelHit()->connect([&](AbstractAnimationPtr, std::string name, uint time)
-    {
-        if (name == "1to0" && _lane != 0)
-            _lane = 0;
-        else if ((name == "0to1" || name == "2to1") && _lane != 1)
-            _lane = 1;
-        else if (name == "1to2" && _lane != 2)
-            _lane = 2;
-        else
-            return;
-        
         std::cout << "car on lane " << _lane << std::endl;
     });
 
-    _carAnimatedNode->addComponent(_carLaneAnimation->seek(0)->stop());
+    _carAnimatedNode->addComponent(_laneMotion);
 
     _root->addChild(_carAnimatedNode);
 }
@@ -301,6 +254,14 @@ CarScript::initCamera()
     _cameraAnimContainer = scene::Node::create("cameraAnimContainer")->addComponent(Transform::create());
     _cameraContainer = scene::Node::create("cameraContainer")->addComponent(Transform::create());
     _camera = scene::Node::create("camera")->addComponent(Transform::create());
+
+#ifdef TREX_HEADLESS
+    node->addComponent(Transform::create());
+
+    _cameraAnimContainer->addChild(_camera);
+    _cameraContainer->addChild(_cameraAnimContainer);
+    node->addChild(_cameraContainer);
+#else
     _oculusDetected = OculusVRCamera::detected();
 
     if (_oculusDetected)
@@ -318,7 +279,7 @@ CarScript::initCamera()
         )));
 
         _camera
-            ->addComponent(PerspectiveCamera::create(_canvas->aspectRatio(), 1.0f))
+            ->addComponent(PerspectiveCamera::create(_canvas->aspectRatio(), TREX_CAMERA_FOV))
             ->addComponent(Renderer::create(0x050514ff));
     }
 
@@ -350,11 +311,13 @@ CarScript::initCamera()
                _camera->component<PerspectiveCamera>()->aspectRatio(ratio);
        }
    });
+#endif
 }
 
 void
 CarScript::moveCameraToNode(NodePtr node)
 {
+#ifndef TREX_HEADLESS
     auto previousPosition = _camera->component<Transform>()->modelToWorldMatrix(true)->translation();
 
     auto worldParentMatrix = node->parent()->component<Transform>()->modelToWorldMatrix(true);
@@ -382,32 +345,36 @@ CarScript::moveCameraToNode(NodePtr node)
     auto worldMatrix = _camera->component<Transform>()->modelToWorldMatrix(true);
 
     _camera->component<Transform>()->matrix()->prependScale(-1.0f / worldMatrix->data()[0], 1.0f / worldMatrix->data()[5], -1.0f / worldMatrix->data()[10]);
+
+    // the look controls now turn the camera around its new orientation
+    _cameraBaseMatrix->copyFrom(_camera->component<Transform>()->matrix());
+    _cameraYaw = 0.f;
+    _cameraPitch = 0.f;
  
 
     std::cout << _camera->component<Transform>()->modelToWorldMatrix(true)->toString() << std::endl;
+#endif
 }
 
 void
 CarScript::handleControls()
 {
-    auto leftPressed = _canvas->keyboard()->keyIsDown(Keyboard::Key::LEFT) || (-_joyLX > MOVE_THRESHOLD);
-    auto rightPressed = _canvas->keyboard()->keyIsDown(Keyboard::Key::RIGHT) || (_joyLX > MOVE_THRESHOLD);
+    const auto& input = _input->next();
 
     if (!_gameOver)
     {
-        if (_canvas->keyboard()->keyIsDown(Keyboard::Key::F))
+        if (input.wasPressed(InputSnapshot::START))
             startGame();
 
-        if (_canvas->keyboard()->keyIsDown(Keyboard::Key::END))
+        if (input.isDown(InputSnapshot::END_GAME))
         {
             _gameOver = true;
         }
     }
 
-    if (_canvas->keyboard()->keyIsDown(Keyboard::Key::ESCAPE) && _gameOver)
+    if (input.isDown(InputSnapshot::QUIT) && _gameOver)
     {
-        auto position = _carSymbol->component<Transform>()->modelToWorld(Vector3::create());
-        auto z = int(position->z());
+        auto z = int(_distance);
 
 #if defined(EMSCRIPTEN)
         std::string eval = "gameOver(" + std::to_string(z) + ");";
@@ -415,83 +382,62 @@ CarScript::handleControls()
 #endif
     }
 
-    if (_canvas->keyboard()->keyIsDown(Keyboard::Key::ESCAPE))
+    if (input.isDown(InputSnapshot::QUIT))
     {
+        reportLatency();
         _canvas->quit();
     }
 
-    if (_canvas->keyboard()->keyIsDown(Keyboard::Key::E) && !_leftCameraDown)
+    if (input.wasPressed(InputSnapshot::TURN_LEFT))
     {
-        _leftCameraDown = true;
-        _joyRX = -1.0f;
-    }
-    else if (!_canvas->keyboard()->keyIsDown(Keyboard::Key::E) && _leftCameraDown)
-    {
-        _joyRX = 0.f;
-        _leftCameraDown = false;
-    }
-    
-
-    if (_canvas->keyboard()->keyIsDown(Keyboard::Key::R) && !_rightCameraDown)
-    {
-        _joyRX = 1.0f;
-        _rightCameraDown = true;
-    }
-    else if (!_canvas->keyboard()->keyIsDown(Keyboard::Key::R) && _rightCameraDown)
-    {
-        _joyRX = 0.f;
-        _rightCameraDown = false;
-    }
-    
-    if (leftPressed && !_leftDown)
-    {
-        turnLeft();
+        if (turnLeft())
+        {
+#ifdef TREX_ENABLE_LATENCY_PROBE
+            _latencyProbe->laneChangeStarted(_sceneManager->frameId(), input.eventTime[InputSnapshot::TURN_LEFT], input.time, InputMapper::now());
+#endif
+        }
     }
-    else if (rightPressed && !_rightDown)
+    else if (input.wasPressed(InputSnapshot::TURN_RIGHT))
     {
-        turnRight();
+        if (turnRight())
+        {
+#ifdef TREX_ENABLE_LATENCY_PROBE
+            _latencyProbe->laneChangeStarted(_sceneManager->frameId(), input.eventTime[InputSnapshot::TURN_RIGHT], input.time, InputMapper::now());
+#endif
+        }
     }
 
-    _leftDown = leftPressed;
-    _rightDown = rightPressed;
-
     if (_oculusDetected)
         return;
 
     auto dtRatio = (deltaTime() / 16.f) / 18.f;
+    auto yaw = _cameraYaw;
+    auto pitch = _cameraPitch;
 
-    auto axis = Vector3::create(0.f, 0.f, 0.f);
+    if (std::abs(input.lookX) > CAMERA_THRESHOLD)
+        yaw -= input.lookX > 0.f ? dtRatio : -dtRatio;
 
-    if (std::abs(_joyRX) > CAMERA_THRESHOLD)
-    {
-        axis->y(-_joyRX);
-        axis = _camera->component<Transform>()->deltaWorldToModel(axis)->normalize();
-    }
-
-    auto angle = dtRatio * -_joyRY;
+    if (std::abs(input.lookY) > CAMERA_THRESHOLD)
+        pitch = std::max(-float(CAMERA_V_LIMIT), std::min(float(CAMERA_V_LIMIT), pitch - dtRatio * input.lookY));
 
-    if (std::abs(_joyRY) > CAMERA_THRESHOLD)// && !((_cameraVAngle >= CAMERA_V_LIMIT && angle > 0.f) || (_cameraVAngle <= 0.f && angle < 0.f)))
+    if (yaw != _cameraYaw || pitch != _cameraPitch)
     {
-        /*if (_cameraVAngle + angle > CAMERA_V_LIMIT)
-        {
-            angle = CAMERA_V_LIMIT - _cameraVAngle;
-            _cameraVAngle = CAMERA_V_LIMIT;
-        }
-        else if (_cameraVAngle + angle < 0.f)
-        {
-            angle = 0.f - _cameraVAngle;
-            _cameraVAngle = 0.f;
-        }
-        else
-        {
-            _cameraVAngle += angle;
-        }*/
+        _cameraYaw = yaw;
+        _cameraPitch = pitch;
 
-        _camera->component<Transform>()->matrix()->prependRotationX(angle);
+        _camera->component<Transform>()->matrix()
+            ->copyFrom(_cameraBaseMatrix)
+            ->prependRotationY(_cameraYaw)
+            ->prependRotationX(_cameraPitch);
     }
+}
 
-    if (axis->length() != 0.f)
-        _camera->component<Transform>()->matrix()->prependRotation(dtRatio, axis);
+void
+CarScript::reportLatency()
+{
+#ifdef TREX_ENABLE_LATENCY_PROBE
+    _latencyProbe->report(std::cout);
+#endif
 }
 
 void
@@ -505,33 +451,32 @@ CarScript::startGame()
     }
 }
 
-void
+bool
 CarScript::turnLeft()
 {
     if (_speed <= 0.0f)
-        return;
+        return false;
 
-    if (_lane - 1 != _lockedLane && _lane > 0 && !_carLaneAnimation->isPlaying())
-    {
-        std::string laneChange = std::to_string(_lane) + "to" + std::to_string((_lane - 1));
+    if (_lane - 1 == _lockedLane || _lane == 0 || _laneMotion->isMoving())
+        return false;
 
-        _carLaneAnimation->stop()->setPlaybackWindow(laneChange + "_start", laneChange + "_end")->seek(laneChange + "_start")->play();
-    }
+    _laneMotion->moveTo(_lane - 1);
 
+    return true;
 }
 
-void
+bool
 CarScript::turnRight()
 {
     if (_speed <= 0.0f)
-        return;
+        return false;
 
-    if (_lane + 1 != _lockedLane && _lane < (NUM_LANES - 1) && !_carLaneAnimation->isPlaying())
-    {
-        std::string laneChange = std::to_string(_lane) + "to" + std::to_string((_lane + 1));
+    if (_lane + 1 == _lockedLane || _lane == NUM_LANES - 1 || _laneMotion->isMoving())
+        return false;
 
-        _carLaneAnimation->stop()->setPlaybackWindow(laneChange + "_start", laneChange + "_end")->seek(laneChange + "_start")->play();
-    }
+    _laneMotion->moveTo(_lane + 1);
+
+    return true;
 }
 
 void
@@ -543,77 +488,61 @@ CarScript::update(scene::Node::Ptr target)
     auto dz = (_speed / 3600.f) * deltaTime();
 
     if (_gameStarted && !_eating)
+    {
         _target->component<Transform>()->matrix()->appendTranslation(0.f, 0.f, dz);
+        _world->invalidate(WorldCache::CAR);
+        _distance += dz;
+
+        if (_target->component<Transform>()->z() > TREX_ORIGIN_SHIFT_DISTANCE)
+            shiftOrigin();
+    }
     else if (_eating)
     {
         _carSymbol->component<Transform>()->matrix()->appendTranslation(0.f, 0.f, -dz);
 
-        _speed -= 0.5f;
+        _speed -= CAR_EATEN_DECELERATION * deltaTime();
     }
 
+#ifndef TREX_HEADLESS
     handleControls();
+#endif
 
-#ifdef CAR_SCORE_ENABLE
-    updateScoreBoard();
-    updateKmBoard();
+#if defined(CAR_SCORE_ENABLE) && !defined(TREX_HEADLESS)
+    _scoreBoard->value(_scoreCounter, int(_distance));
+    _scoreBoard->value(_kmCounter, int(_speed));
 #endif
     static bool displayquad = true;
 
     if (_gameOver && displayquad)
     {
         std::cout << "gameover" << std::endl;
+        reportLatency();
+#ifndef TREX_HEADLESS
         _screenQuad->component<Surface>()->material()->set("diffuseMap", _sceneManager->assets()->texture("texture/endscreen.png"));
         _screenQuad->component<Surface>()->visible(true);
+#endif
         //_camera->addChild(_screenQuad);
         _gameOver = false;
     }
 }
 
 void
-CarScript::stop(scene::Node::Ptr target)
+CarScript::shiftOrigin()
 {
-    std::cout << "CarScript stop" << std::endl;
+    // a multiple of the chunk length, so that the road grid is not offset
+    const auto shift = float(TREX_ORIGIN_SHIFT_DISTANCE);
 
-    if (_target == target)
-        _target = nullptr;
-}
+    _target->component<Transform>()->matrix()->appendTranslation(0.f, 0.f, -shift);
+    _world->invalidate();
 
-void
-CarScript::updateScoreBoard()
-{
-    auto position = _carSymbol->component<Transform>()->modelToWorld(Vector3::create());
-    auto z = (int)position->z();
-    
-    int counter = 0;
-    while(z != 0)
-    {
-        auto digit = z % 10;
-
-        auto basicMaterial = std::static_pointer_cast<minko::material::BasicMaterial>(
-            _digitNodes[counter]->component<Surface>()->material()
-        );
-        basicMaterial->uvOffset(0.1f * digit, 0);
-
-        counter++;
-        z /= 10;
-    }
+    _originShifted->execute(shift);
 }
 
 void
-CarScript::updateKmBoard()
+CarScript::stop(scene::Node::Ptr target)
 {
-    auto speed = int(_speed);
-    int counter = 0;
-    while (speed != 0)
-    {
-        auto digit = speed % 10;
-
-        auto basicMaterial = std::static_pointer_cast<minko::material::BasicMaterial>(
-            _kmDigitNodes[counter]->component<Surface>()->material()
-        );
-        basicMaterial->uvOffset(0.1f * digit, 0.5f);
+    std::cout << "CarScript stop" << std::endl;
 
-        counter++;
-        speed /= 10;
-    }
+    if (_target == target)
+        _target = nullptr;
 }
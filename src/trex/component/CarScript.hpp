@@ -21,6 +21,13 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "minko/Minko.hpp"
 #include "minko/MinkoSDL.hpp"
 #include "trex/Config.hpp"
+#include "trex/InputMapper.hpp"
+#include "trex/LatencyProbe.hpp"
+#include "trex/SimulationClock.hpp"
+#include "trex/VoicePool.hpp"
+#include "trex/WorldCache.hpp"
+#include "trex/component/LaneMotion.hpp"
+#include "trex/component/ScoreBoard.hpp"
 
 namespace trex
 {
@@ -33,18 +40,16 @@ namespace trex
 
         private:
             typedef minko::Signal<minko::AbstractCanvas::Ptr, minko::uint, minko::uint>::Slot       ResizedSlot;
+            typedef minko::Signal<minko::component::SceneManager::Ptr, float, float>::Slot          FrameBeginSlot;
             typedef minko::scene::Node::Ptr                                                         NodePtr;
-
-            typedef minko::Signal<minko::AbstractCanvas::Ptr, minko::input::Joystick::Ptr>::Slot    JoystickSlot;
-            typedef minko::Signal<minko::input::Joystick::Ptr, int, int, int>::Slot                 JoystickAxisMotionSlot;
-            typedef minko::Signal<minko::input::Joystick::Ptr, int, int>::Slot                      JoystickButtonDownSlot;
-            typedef minko::input::Joystick::Ptr                                                     JoystickPtr;
+            typedef minko::Signal<float>::Ptr                                                       OriginShiftedSignalPtr;
 
             typedef minko::component::Animation::Ptr                                                AnimationPtr;
             typedef minko::component::AbstractAnimation::Ptr                                        AbstractAnimationPtr;
             typedef minko::Signal<AbstractAnimationPtr, std::string, minko::uint>::Slot             AnimationLabelHitSlot;
+            typedef LaneMotion::EventSignal::Slot                                                   LaneMotionEventSlot;
 
-            CarScript(minko::Canvas::Ptr, NodePtr);
+            CarScript(minko::Canvas::Ptr, NodePtr, SimulationClock::Ptr);
 
         public:
             ~CarScript()
@@ -53,9 +58,9 @@ namespace trex
 
             static
             Ptr
-            create(minko::Canvas::Ptr canvas, NodePtr root)
+            create(minko::Canvas::Ptr canvas, NodePtr root, SimulationClock::Ptr clock)
             {
-                auto script = std::shared_ptr<CarScript>(new CarScript(canvas, root));
+                auto script = std::shared_ptr<CarScript>(new CarScript(canvas, root, clock));
                 
                 script->initialize();
 
@@ -83,6 +88,46 @@ namespace trex
                 return _speed - CAR_BASE_SPEED;
             }
 
+            inline
+            double
+            distance() const
+            {
+                return _distance;
+            }
+
+            // Executed with the z offset subtracted from the whole world when the car
+            // is brought back toward the origin.
+            inline
+            OriginShiftedSignalPtr
+            originShifted() const
+            {
+                return _originShifted;
+            }
+
+            // World positions of the car and of the actors chasing it, shared by the scripts.
+            inline
+            WorldCache::Ptr
+            world() const
+            {
+                return _world;
+            }
+
+            // The clock the whole scene runs on.
+            inline
+            SimulationClock::Ptr
+            clock() const
+            {
+                return _clock;
+            }
+
+            // The voices shared by every dino, so that their mix stays bounded.
+            inline
+            VoicePool::Ptr
+            voices() const
+            {
+                return _voices;
+            }
+
             inline
             int
             lane()
@@ -90,6 +135,13 @@ namespace trex
                 return _lane;
             }
 
+            inline
+            float
+            lateralPosition() const
+            {
+                return _carAnimatedNode->component<minko::component::Transform>()->x();
+            }
+
             void
             lockLane(int laneId, bool locked);
 
@@ -142,6 +194,16 @@ namespace trex
                 _eating = v;
             }
 
+            void
+            startGame();
+
+            // Return true if a lane change started.
+            bool
+            turnLeft();
+
+            bool
+            turnRight();
+
         protected:
             void
             initialize();
@@ -171,26 +233,14 @@ namespace trex
             void
             initParticles();
             
-            void
-            initJoysticks();
-
             void
             handleControls();
 
             void
-            startGame();
-
-            void
-            turnLeft();
-
-            void
-            turnRight();
-
-            void
-            updateScoreBoard();
+            reportLatency();
 
             void
-            updateKmBoard();
+            shiftOrigin();
 
         private:
             minko::component::SceneManager::Ptr     _sceneManager;
@@ -202,19 +252,20 @@ namespace trex
             NodePtr                                 _carAnimatedNode;
             NodePtr                                 _carSymbol;
 
-            AnimationPtr                            _carLaneAnimation;
-            AnimationLabelHitSlot                   _carLaneAnimationLabelHit;
+            LaneMotion::Ptr                         _laneMotion;
+            LaneMotionEventSlot                     _laneMotionEvent;
 
             NodePtr                                 _camera;
             NodePtr                                 _cameraContainer;
             NodePtr                                 _cameraAnimContainer;
             ResizedSlot                             _resizedSlot;
 
-            JoystickPtr                             _joystick;
-            JoystickSlot                            _joystickAdded;
-            JoystickSlot                            _joystickRemoved;
-            JoystickAxisMotionSlot                  _joystickAxisMotion;
-            JoystickButtonDownSlot                  _joystickButtonDown;
+            InputMapper::Ptr                        _input;
+            LatencyProbe::Ptr                       _latencyProbe;
+            FrameBeginSlot                          _frameBeginSlot;
+            WorldCache::Ptr                         _world;
+            SimulationClock::Ptr                    _clock;
+            VoicePool::Ptr                          _voices;
 
             std::string                             _currentScreen;
 
@@ -224,27 +275,22 @@ namespace trex
             bool                                    _gameOver;
             bool                                    _oculusDetected;
 
-            float                                   _joyLX;
-            float                                   _joyLY;
-            float                                   _joyRX;
-            float                                   _joyRY;
-
             float                                   _speed; //in km/h
+            double                                  _distance;
+            OriginShiftedSignalPtr                  _originShifted;
             int                                     _lane;
 
-            bool                                    _leftDown;
-            bool                                    _rightDown;
-
-            bool                                    _leftCameraDown;
-            bool                                    _rightCameraDown;
-
-            float                                   _cameraVAngle;
+            // the desktop camera orientation, applied to _cameraBaseMatrix
+            float                                   _cameraYaw;
+            float                                   _cameraPitch;
+            minko::math::Matrix4x4::Ptr             _cameraBaseMatrix;
 
             int                                     _lockedLane;
 
             int                                     _obstacleHitCount;
-            std::array<NodePtr, 5>                  _digitNodes;
-            std::array<NodePtr, 5>                  _kmDigitNodes;
+            ScoreBoard::Ptr                         _scoreBoard;
+            unsigned int                            _scoreCounter;
+            unsigned int                            _kmCounter;
 
             bool                                    _eating;
         };
@@ -0,0 +1,152 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DinoHerd.hpp"
+#include "CarScript.hpp"
+#include "LaneMotion.hpp"
+#include "trex/AiLod.hpp"
+
+using namespace minko;
+using namespace minko::component;
+using namespace trex::component;
+
+DinoHerd::DinoHerd(CarScriptPtr car, unsigned int numDinos) :
+    _car(car),
+    _frame(0),
+    _z(numDinos),
+    _speed(numDinos, 0.f),
+    _requiredSpeed(numDinos, TREX_DINO_BASE_SPEED),
+    _gap(numDinos),
+    _lane(numDinos),
+    _fromX(numDinos),
+    _toX(numDinos),
+    _laneTime(numDinos, float(LANE_CHANGE_DURATION)),
+    _offLaneTime(numDinos, 0.f),
+    _followDelay(numDinos),
+    _aiTime(numDinos, 0.f)
+{
+    // the main dino takes the first row, in the middle lane
+    for (unsigned int i = 0; i < numDinos; ++i)
+    {
+        auto row = i / NUM_LANES + 1;
+
+        _lane[i] = i % NUM_LANES;
+        _fromX[i] = LaneMotion::laneX(_lane[i]);
+        _toX[i] = _fromX[i];
+        _gap[i] = TREX_DINO_LENGTH / 2 + TREX_DINO_DIST + row * TREX_HERD_ROW_SPACING;
+        _z[i] = -_gap[i] - TREX_DINO_STARTING_DIST;
+        _followDelay[i] = TREX_DINO_FOLLOWING_STATE_DELAY * 1000.f * (1.f + (i % 4) * .25f);
+    }
+}
+
+void
+DinoHerd::start(scene::Node::Ptr target)
+{
+    if (_target != nullptr)
+        return;
+
+    _target = target;
+
+    _originShiftedSlot = _car->originShifted()->connect([&](float shift)
+    {
+        for (auto& z : _z)
+            z -= shift;
+    });
+}
+
+float
+DinoHerd::carZ() const
+{
+    return _car->world()->position(WorldCache::CAR).z;
+}
+
+void
+DinoHerd::update(scene::Node::Ptr target)
+{
+    if (target != _target || !_car->gameStarted())
+        return;
+
+    const auto numDinos = _z.size();
+    const auto dt = deltaTime();
+    const auto carZ = this->carZ();
+    const auto carLane = _car->lane();
+    const auto carX = LaneMotion::laneX(carLane);
+    const auto carDeltaSpeed = _car->deltaSpeed();
+
+    ++_frame;
+
+    // AI pass, decimated for the dinos far from the car
+    for (unsigned int i = 0; i < numDinos; ++i)
+    {
+        _aiTime[i] += dt;
+
+        auto distance = carZ - _z[i];
+
+        if (!AiLod::ticks(_frame, i, distance))
+            continue;
+
+        auto aiTime = _aiTime[i];
+
+        _aiTime[i] = 0.f;
+        _offLaneTime[i] = _lane[i] != carLane ? _offLaneTime[i] + aiTime : 0.f;
+
+        if (_offLaneTime[i] > _followDelay[i] && _laneTime[i] >= LANE_CHANGE_DURATION)
+        {
+            _fromX[i] = _toX[i];
+            _toX[i] = carX;
+            _lane[i] = carLane;
+            _laneTime[i] = 0.f;
+            _offLaneTime[i] = 0.f;
+        }
+
+        auto requiredSpeed = TREX_DINO_BASE_SPEED + (distance - _gap[i]) * TREX_HERD_CATCH_UP;
+
+        _requiredSpeed[i] = std::max(TREX_DINO_RECOVERING_STATE_SPEED, std::min(TREX_DINO_ACCELERATING_STATE_SPEED, requiredSpeed));
+    }
+
+    // motion pass, on every frame
+    for (unsigned int i = 0; i < numDinos; ++i)
+    {
+        _laneTime[i] = std::min(_laneTime[i] + dt, float(LANE_CHANGE_DURATION));
+        _speed[i] = _requiredSpeed[i] + carDeltaSpeed;
+        _z[i] += (_speed[i] / 3600.f) * dt;
+    }
+}
+
+float
+DinoHerd::meanDistanceToCar() const
+{
+    if (_z.empty())
+        return 0.f;
+
+    const auto carZ = this->carZ();
+    auto sum = 0.f;
+
+    for (auto z : _z)
+        sum += carZ - z;
+
+    return sum / _z.size();
+}
+
+void
+DinoHerd::stop(scene::Node::Ptr target)
+{
+    if (target == _target)
+        _target = nullptr;
+}
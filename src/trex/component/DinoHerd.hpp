@@ -0,0 +1,127 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    namespace component
+    {
+        class CarScript;
+    }
+}
+
+namespace trex
+{
+    namespace component
+    {
+        // A herd of dinos chasing the car behind the main DinoScript. The dinos are not
+        // scene nodes: their state is kept in parallel arrays updated in a single pass per
+        // frame, so that the cost stays linear in the number of dinos. Each dino keeps a slot
+        // behind the car, row by row, and follows the car lane after a per-dino delay. Their
+        // AI runs at the rate of their AiLod tier, their motion on every frame.
+        class DinoHerd : public minko::component::AbstractScript
+        {
+        public:
+            typedef std::shared_ptr<DinoHerd>   Ptr;
+
+        private:
+            typedef minko::scene::Node::Ptr                     NodePtr;
+            typedef std::shared_ptr<CarScript>                  CarScriptPtr;
+            typedef minko::Signal<float>::Slot                  OriginShiftedSlot;
+
+        private:
+            CarScriptPtr                                _car;
+            NodePtr                                     _target;
+            OriginShiftedSlot                           _originShiftedSlot;
+            minko::uint                                 _frame;
+
+            std::vector<float>                          _z;
+            std::vector<float>                          _speed;
+            std::vector<float>                          _requiredSpeed;
+            std::vector<float>                          _gap;
+            std::vector<int>                            _lane;
+            std::vector<float>                          _fromX;
+            std::vector<float>                          _toX;
+            std::vector<float>                          _laneTime;
+            std::vector<float>                          _offLaneTime;
+            std::vector<float>                          _followDelay;
+            std::vector<float>                          _aiTime;
+
+        public:
+            static
+            Ptr
+            create(CarScriptPtr car, unsigned int numDinos)
+            {
+                return std::shared_ptr<DinoHerd>(new DinoHerd(car, numDinos));
+            }
+
+            inline
+            unsigned int
+            numDinos() const
+            {
+                return _z.size();
+            }
+
+            inline
+            float
+            z(unsigned int dino) const
+            {
+                return _z[dino];
+            }
+
+            inline
+            float
+            x(unsigned int dino) const
+            {
+                return _fromX[dino] + (_toX[dino] - _fromX[dino]) * (_laneTime[dino] / LANE_CHANGE_DURATION);
+            }
+
+            inline
+            int
+            lane(unsigned int dino) const
+            {
+                return _lane[dino];
+            }
+
+            float
+            meanDistanceToCar() const;
+
+        protected:
+            void
+            start(NodePtr target);
+
+            void
+            update(NodePtr target);
+
+            void
+            stop(NodePtr target);
+
+        private:
+            DinoHerd(CarScriptPtr car, unsigned int numDinos);
+
+            float
+            carZ() const;
+        };
+    }
+}
@@ -23,6 +23,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "CarScript.hpp"
 #include "trex/Config.hpp"
 #include "trex/PseudoRandom.hpp"
+#include "trex/AiLod.hpp"
 
 using namespace minko;
 using namespace minko::component;
@@ -30,6 +31,9 @@ using namespace minko::audio;
 using namespace minko::math;
 using namespace trex::component;
 
+uint
+DinoScript::_numInstances = 0;
+
 std::vector<std::string>
 DinoScript::_eatSamples =
 {
@@ -74,13 +78,6 @@ DinoScript::_rushSamples =
     "sound/trex_roar_middle_3.ogg"
 };
 
-
-std::map<
-    audio::PositionalSound::Ptr,
-    Signal<SoundChannel::Ptr>::Slot
->
-DinoScript::_walkSlots;
-
 const std::string LABEL_DINO_FOOT_STEP_LEFT_START = "footStepLeftStart";
 const std::string LABEL_DINO_FOOT_STEP_LEFT_STOP = "footStepLeftStop";
 const std::string LABEL_DINO_FOOT_STEP_RIGHT_START = "footStepRightStart";
@@ -96,54 +93,67 @@ const std::string LABEL_DINO_EAT_STOP = "eatStop";
 const std::string LABEL_DINO_RUN_START = "runStart";
 const std::string LABEL_DINO_RUN_STOP = "runStop";
 
-std::map<std::string, uint>
+std::vector<DinoScript::Label>
 DinoScript::_labels = {
-    { LABEL_DINO_FOOT_STEP_LEFT_START, 0 },
-    { LABEL_DINO_FOOT_STEP_LEFT_STOP, 500 },
-    { LABEL_DINO_FOOT_STEP_RIGHT_START, 500 },
-    { LABEL_DINO_FOOT_STEP_RIGHT_STOP, 1000 },
-    { LABEL_DINO_SCREAM_START, 1500 },
-    { LABEL_DINO_SCREAM_STOP, 3500 },
-    { LABEL_DINO_ATTACK_START, 5000 },
-    { LABEL_DINO_ATTACK_STOP, 7333 },
-    { LABEL_DINO_EAT_START, 8000 },
-    { LABEL_DINO_EAT_MOVE_CAMERA, 8233 },
-    { LABEL_DINO_EAT_GAME_OVER, 11000 },
-    { LABEL_DINO_EAT_STOP, 13000 },
-    { LABEL_DINO_RUN_START, 14000 },
-    { LABEL_DINO_RUN_STOP, 14800 },
-    { "footStep2", 2000 },
-    { "footStep3", 2500 },
-    { "footStep4", 3000 },
-    { "footStep5", 3500 },
-    { "footStep6", 4833 },
-    { "footStep7", 5333 },
-    { "footStep8", 5866 },
-    { "footStep9", 6333 },
-    { "footStep10", 6833 },
-    { "footStep11", 7333 },
-    { "footStep12", 14400 },
-    { "footStep13", 7333 },
-    { "footStep14", 7333 }
+    { LABEL_DINO_FOOT_STEP_LEFT_START, 0, LabelAction::STEP },
+    { LABEL_DINO_FOOT_STEP_LEFT_STOP, 500, LabelAction::NONE },
+    { LABEL_DINO_FOOT_STEP_RIGHT_START, 500, LabelAction::STEP },
+    { LABEL_DINO_FOOT_STEP_RIGHT_STOP, 1000, LabelAction::NONE },
+    { LABEL_DINO_SCREAM_START, 1500, LabelAction::NONE },
+    { LABEL_DINO_SCREAM_STOP, 3500, LabelAction::SCREAM_STOP },
+    { LABEL_DINO_ATTACK_START, 5000, LabelAction::NONE },
+    { LABEL_DINO_ATTACK_STOP, 7333, LabelAction::ATTACK_STOP },
+    { LABEL_DINO_EAT_START, 8000, LabelAction::NONE },
+    { LABEL_DINO_EAT_MOVE_CAMERA, 8233, LabelAction::EAT_MOVE_CAMERA },
+    { LABEL_DINO_EAT_GAME_OVER, 11000, LabelAction::EAT_GAME_OVER },
+    { LABEL_DINO_EAT_STOP, 13000, LabelAction::NONE },
+    { LABEL_DINO_RUN_START, 14000, LabelAction::NONE },
+    { LABEL_DINO_RUN_STOP, 14800, LabelAction::NONE },
+    { "footStep2", 2000, LabelAction::STEP },
+    { "footStep3", 2500, LabelAction::STEP },
+    { "footStep4", 3000, LabelAction::STEP },
+    { "footStep5", 3500, LabelAction::STEP },
+    { "footStep6", 4833, LabelAction::STEP },
+    { "footStep7", 5333, LabelAction::STEP },
+    { "footStep8", 5866, LabelAction::STEP },
+    { "footStep9", 6333, LabelAction::STEP },
+    { "footStep10", 6833, LabelAction::STEP },
+    { "footStep11", 7333, LabelAction::STEP },
+    { "footStep12", 14400, LabelAction::STEP },
+    { "footStep13", 7333, LabelAction::STEP },
+    { "footStep14", 7333, LabelAction::STEP }
 };
 
-DinoScript::DinoScript(NodePtr root) :
-    _speed(),
+DinoScript::DinoScript(NodePtr root, CarScriptPtr car) :
     _dinoSymbol(nullptr),
-    _currentState(State::NONE),
-    _lane((NUM_LANES - 1) / 2),
+    _speed(),
     _currentTimeStamp(0.0f),
+    _car(car),
+    _lane((NUM_LANES - 1) / 2),
     _hadSameLaneAsCar(false),
     _root(root),
     _wasFollowing(false),
     _isEating(false),
-    _gameIsOver(false)
+    _gameIsOver(false),
+    _animationStep(1),
+    _sampledAnimationTime(0),
+    _footStepRandom(PseudoRandom<std::string>::create(_footStepSamples)),
+    _roarRandom(PseudoRandom<std::string>::create(_roarSamples)),
+    _attackRandom(PseudoRandom<std::string>::create(_attackSamples)),
+    _rushRandom(PseudoRandom<std::string>::create(_rushSamples)),
+    _frame(0),
+    _lastLabelTime(-1),
+    _lastLabelFrame(0),
+    _worldSlot(WorldCache::CAR),
+    _aiId(_numInstances++)
+#ifdef TREX_HEADLESS
+    , _animationWindowStart(0),
+    _animationWindowStop(0),
+    _animationWindowId(0),
+    _animationTime(0.0f),
+    _animationPlaying(false)
+#endif
 {
-    _timers.insert(std::make_pair("stateChanged", 0.0f));
-    _timers.insert(std::make_pair("dummyAnimation", 0.0f));
-    _timers.insert(std::make_pair("carEnteredLane", 0.0f));
-    _timers.insert(std::make_pair("carExitedLane", 0.0f));
-    _timers.insert(std::make_pair("dinoAttackEnded", 0.0f));
 }
 
 void
@@ -154,6 +164,7 @@ DinoScript::initialize()
     _requiredSpeed = TREX_DINO_BASE_SPEED;
 
     initDinoLaneAnimation();
+    initStateMachine();
 }
 
 void
@@ -162,73 +173,8 @@ DinoScript::initDinoLaneAnimation()
     _dinoLaneAnimatedNode = minko::scene::Node::create();
     _dinoLaneAnimatedNode->addComponent(Transform::create());
 
-    auto lane0 = Matrix4x4::create()->appendTranslation(LANE_WIDTH, 0.f, 0.f);
-    auto lane1 = Matrix4x4::create();
-    auto lane2 = Matrix4x4::create()->appendTranslation(-LANE_WIDTH, 0.f, 0.f);
-
-    auto lane0to1 = Matrix4x4::create()->prependRotationY(float(-M_PI_4) / 5.5f)->appendTranslation(LANE_WIDTH / 2, 0.f, 0.f);
-    auto lane1to0 = Matrix4x4::create()->prependRotationY(float(M_PI_4) / 5.5f)->appendTranslation(LANE_WIDTH / 2, 0.f, 0.f);
-
-    auto lane1to2 = Matrix4x4::create()->prependRotationY(float(-M_PI_4) / 5.5f)->appendTranslation(-LANE_WIDTH / 2, 0.f, 0.f);
-    auto lane2to1 = Matrix4x4::create()->prependRotationY(float(M_PI_4) / 5.5f)->appendTranslation(-LANE_WIDTH / 2, 0.f, 0.f);
-
-    auto lane0to2 = Matrix4x4::create()->prependRotationY(float(-M_PI_4) / 2.f)->appendTranslation(0.f, 0.f, 0.f);
-    auto lane2to0 = Matrix4x4::create()->prependRotationY(float(M_PI_4) / 2.f)->appendTranslation(0.f, 0.f, 0.f);
-
-    std::vector<Matrix4x4::Ptr> matrices = { lane1, lane1to0, lane0, lane0to2, lane2, lane2to0, lane0, lane0to1, lane1, lane1to2, lane2, lane2to1, lane1 };
-    std::vector<uint> timetable;
-
-    for (int i = 0; i < 13; ++i)
-    {
-        timetable.push_back(i * LANE_CHANGE_DURATION / 2);
-    }
-
-    auto timeline = animation::Matrix4x4Timeline::create("transform.matrix", 3000, timetable, matrices, true);
-    _dinoLaneAnimation = Animation::create({ timeline });
-
-    auto halfDuration = static_cast<unsigned int>(LANE_CHANGE_DURATION * 0.5f);
-
-    _dinoLaneAnimation->addLabel("1to0_start", 0);
-    _dinoLaneAnimation->addLabel("1to0", halfDuration);
-    _dinoLaneAnimation->addLabel("1to0_end", LANE_CHANGE_DURATION);
-
-    _dinoLaneAnimation->addLabel("0to2_start", LANE_CHANGE_DURATION);
-    _dinoLaneAnimation->addLabel("0to2", LANE_CHANGE_DURATION + halfDuration);
-    _dinoLaneAnimation->addLabel("0to2_end", LANE_CHANGE_DURATION * 2);
-
-    _dinoLaneAnimation->addLabel("2to0_start", LANE_CHANGE_DURATION * 2);
-    _dinoLaneAnimation->addLabel("2to0", LANE_CHANGE_DURATION * 2 + halfDuration);
-    _dinoLaneAnimation->addLabel("2to0_end", LANE_CHANGE_DURATION * 3);
-
-    _dinoLaneAnimation->addLabel("0to1_start", LANE_CHANGE_DURATION * 3);
-    _dinoLaneAnimation->addLabel("0to1", LANE_CHANGE_DURATION * 3 + halfDuration);
-    _dinoLaneAnimation->addLabel("0to1_end", LANE_CHANGE_DURATION * 4);
-
-    _dinoLaneAnimation->addLabel("1to2_start", LANE_CHANGE_DURATION * 4);
-    _dinoLaneAnimation->addLabel("1to2", LANE_CHANGE_DURATION * 4 + halfDuration);
-    _dinoLaneAnimation->addLabel("1to2_end", LANE_CHANGE_DURATION * 5);
-
-    _dinoLaneAnimation->addLabel("2to1_start", LANE_CHANGE_DURATION * 5);
-    _dinoLaneAnimation->addLabel("2to1", LANE_CHANGE_DURATION * 5 + halfDuration);
-    _dinoLaneAnimation->addLabel("2to1_end", LANE_CHANGE_DURATION * 6);
-
-    _dinoLaneAnimation->isLooping(false);
-
-    _dinoLaneAnimationLabelHit = _dinoLaneAnimation->labelHit()->connect([&](AbstractAnimationPtr, std::string name, uint time)
-    {
-        /*if (name == "1to0" && _lane != 0)
-            _lane = 0;
-        else if ((name == "0to1" || name == "2to1") && _lane != 1)
-            _lane = 1;
-        else if (name == "1to2" && _lane != 2)
-            _lane = 2;
-        else
-            return;
-
-        std::cout << "car on lane " << _lane << std::endl;*/
-    });
-
-    _dinoLaneAnimatedNode->addComponent(_dinoLaneAnimation->seek(0)->stop());
+    _laneMotion = LaneMotion::create(_lane);
+    _dinoLaneAnimatedNode->addComponent(_laneMotion);
 
     _root->addChild(_dinoLaneAnimatedNode);
 }
@@ -249,37 +195,53 @@ DinoScript::start(scene::Node::Ptr target)
     _target->addComponent(transform);
 
     _sceneManager = _target->root()->component<SceneManager>();
-    
-    auto carNodes = scene::NodeSet::create(target->root())->descendants(true)->where([](scene::Node::Ptr node)
+
+    _worldSlot = _car->world()->track(_target);
+
+    loadStates(TREX_DINO_STATES_FILENAME);
+
+    _originShiftedSlot = _car->originShifted()->connect([&](float shift)
     {
-        return node->hasComponent<CarScript>();
+        _target->component<Transform>()->matrix()->appendTranslation(0.f, 0.f, -shift);
+        _car->world()->invalidate(_worldSlot);
     });
 
-    _car = carNodes->nodes().at(0)->component<CarScript>();
-
     initDinoSymbol();
 }
 
 void
 DinoScript::initDinoSymbol()
 {
+#ifdef TREX_HEADLESS
+    _dinoSymbol = scene::Node::create("char_trex");
+#else
     _dinoSymbol = _sceneManager->assets()->symbol("model/char_trex.scene");
+#endif
 
     if (!_dinoSymbol->hasComponent<Transform>())
         _dinoSymbol->addComponent(Transform::create());
 
     _dinoSymbol->component<Transform>()->matrix()->appendRotationY(float(M_PI));
 
+#ifdef TREX_HEADLESS
+    _headDummyNode = scene::Node::create("Box_Camera_Game_Over")->addComponent(Transform::create());
+    _dinoSymbol->addChild(_headDummyNode);
+#else
     auto dummyNodes = scene::NodeSet::create(_dinoSymbol)->descendants(true)->where([](scene::Node::Ptr node)
     {
         return node->name() == "Box_Camera_Game_Over";
     });
 
     _headDummyNode = dummyNodes->nodes()[0];
+#endif
 
     _target->addChild(_dinoLaneAnimatedNode);
     _dinoLaneAnimatedNode->addChild(_dinoSymbol);
 
+#ifdef TREX_HEADLESS
+    _dinoSkinnedNode = _dinoSymbol;
+    _animationPlaying = true;
+#else
     auto animNodeSet = scene::NodeSet::create(_dinoSymbol)
         ->descendants(true)
         ->where([](scene::Node::Ptr n)
@@ -300,157 +262,166 @@ DinoScript::initDinoSymbol()
     _dinoSkinnedNode = animNodeSet->nodes().front();
 
 
+    _dinoSkinnedNode->component<MasterAnimation>()
+        ->timeFunction(std::bind(&DinoScript::animationTime, this, std::placeholders::_1));
     _dinoSkinnedNode->component<MasterAnimation>()->play();
 
-    _dinoFootStepLabelHitSlot = _dinoSkinnedNode->component<MasterAnimation>()->labelHit()->connect([&](AbstractAnimation::Ptr, std::string name, uint time)
+    _dinoFootStepLabelHitSlot = _dinoSkinnedNode->component<MasterAnimation>()->labelHit()->connect([&](AbstractAnimation::Ptr, const std::string&, uint time)
     {
-        if (!_car->gameStarted())
-            return;
-
-        if (name == LABEL_DINO_FOOT_STEP_LEFT_START ||
-            name == LABEL_DINO_FOOT_STEP_RIGHT_START ||
-            name == "footStep0" ||
-            name == "footStep1" ||
-            name == "footStep2" ||
-            name == "footStep3" ||
-            name == "footStep4" ||
-            name == "footStep5" ||
-            name == "footStep6" ||
-            name == "footStep7" ||
-            name == "footStep8" ||
-            name == "footStep9" ||
-            name == "footStep10" ||
-            name == "footStep11" ||
-            name == "footStep12" ||
-            name == "footStep13" ||
-            name == "footStep14")
-        {
-            step();
-        }
-        else if (name == LABEL_DINO_ATTACK_STOP)
-        {
-            if (hasSameLaneAsCar())
-                changeCurrentState(TREX_GOD_MODE ? State::RECOVERING : State::AAARGH);
-            else
-                changeCurrentState(State::RECOVERING);
-        }
-        else if (name == LABEL_DINO_SCREAM_STOP)
-        {
-            if (hasSameLaneAsCar())
-                changeCurrentState(State::ACCELERATING);
-            else
-                changeCurrentState(State::WALKING);
-        }
-        else if (name == LABEL_DINO_EAT_GAME_OVER)
-        {
-            gameOver();
-        }
-        else if (name == LABEL_DINO_EAT_MOVE_CAMERA)
-        {
-            _car->moveCameraToNode(_headDummyNode);
-        }
+        labelsHit(time);
     });
 
-    for (auto& kv : _labels)
-        _dinoSkinnedNode->component<MasterAnimation>()->addLabel(kv.first, kv.second);
-}
-
-float
-audibilityCurve(float distance)
-{
-    return 1;
-
-    // FIXME: Return range [0-1] according to distance.
-    float volume = 1.f - std::min(1.f, distance / 30.f);
-    //std::cout << "distance: " << distance << ", volume: " << volume << std::endl;
-    return volume;
+    for (uint labelId = 0; labelId < _labels.size(); ++labelId)
+    {
+        _dinoSkinnedNode->component<MasterAnimation>()->addLabel(_labels[labelId].name, _labels[labelId].time);
+        _labelsAtTime[_labels[labelId].time].push_back(labelId);
+    }
+#endif
 }
 
 void
-DinoScript::attack()
+DinoScript::labelsHit(uint time)
 {
-    static Signal<SoundChannel::Ptr>::Slot attackSlot;
-    static PseudoRandom<std::string>::Ptr random = PseudoRandom<std::string>::create(_attackSamples);
-
-    auto channel = _sceneManager->assets()->sound(random->next())->play(1);
-
-    if (!channel)
+    // MasterAnimation executes labelHit once per label: labels sharing a time are all
+    // dispatched on the first one.
+    if (time == _lastLabelTime && _frame == _lastLabelFrame)
         return;
 
-    auto sound = audio::PositionalSound::create(channel, _car->camera());
-    sound->audibilityCurve(audibilityCurve);
+    _lastLabelTime = time;
+    _lastLabelFrame = _frame;
 
-    attackSlot = channel->complete()->connect([=](SoundChannel::Ptr channel)
-    {
-        _dinoSymbol->removeComponent(sound);
-    });
+    auto labels = _labelsAtTime.find(time);
+
+    if (labels == _labelsAtTime.end())
+        return;
 
-    _dinoSymbol->addComponent(sound);
+    for (auto labelId : labels->second)
+        animationLabelHit(labelId);
 }
 
 void
-DinoScript::roar()
+DinoScript::animationLabelHit(uint labelId)
 {
-    static Signal<SoundChannel::Ptr>::Slot _roarSlot;
-    static PseudoRandom<std::string>::Ptr random = PseudoRandom<std::string>::create(_roarSamples);
+    if (!_car->gameStarted())
+        return;
 
-    auto channel = _sceneManager->assets()->sound(random->next())->play(1);
+    switch (_labels[labelId].action)
+    {
+    case LabelAction::STEP:
+        step();
+        break;
 
-    if (!channel)
-        return;
+    case LabelAction::ATTACK_STOP:
+        _states->trigger(ATTACK_STOPPED);
+        break;
 
-    auto sound = audio::PositionalSound::create(channel, _car->camera());
-    sound->audibilityCurve(audibilityCurve);
+    case LabelAction::SCREAM_STOP:
+        _states->trigger(SCREAM_STOPPED);
+        break;
 
-    _roarSlot = channel->complete()->connect([=](SoundChannel::Ptr channel)
-    {
-        _dinoSymbol->removeComponent(sound);
-    });
+    case LabelAction::EAT_GAME_OVER:
+        gameOver();
+        break;
+
+    case LabelAction::EAT_MOVE_CAMERA:
+        _car->moveCameraToNode(_headDummyNode);
+        break;
 
-    _dinoSymbol->addComponent(sound);
+    default:
+        break;
+    }
 }
 
-void
-DinoScript::rush()
+uint
+DinoScript::labelTime(const std::string& name)
 {
-    static Signal<SoundChannel::Ptr>::Slot _rushSlot;
-    static PseudoRandom<std::string>::Ptr random = PseudoRandom<std::string>::create(_rushSamples);
+    for (const auto& label : _labels)
+        if (label.name == name)
+            return label.time;
 
-    auto channel = _sceneManager->assets()->sound(random->next())->play(1);
+    return 0;
+}
+
+void
+DinoScript::playAnimationWindow(const std::string& startLabel, const std::string& stopLabel)
+{
+#ifdef TREX_HEADLESS
+    _animationWindowStart = labelTime(startLabel);
+    _animationWindowStop = labelTime(stopLabel);
+    _animationTime = float(_animationWindowStart);
+    _animationPlaying = true;
+    ++_animationWindowId;
+#else
+    _dinoSkinnedNode->component<MasterAnimation>()
+        ->setPlaybackWindow(startLabel, stopLabel, true);
+#endif
+}
 
-    if (!channel)
+#ifdef TREX_HEADLESS
+void
+DinoScript::updateAnimation(float deltaTime)
+{
+    // Replays the label hits the skinned MasterAnimation would emit, so that the
+    // label-driven state transitions (scream/attack end, game over) still happen.
+    if (!_animationPlaying)
         return;
 
-    auto sound = audio::PositionalSound::create(channel, _car->camera());
-    sound->audibilityCurve(audibilityCurve);
+    const auto windowId = _animationWindowId;
+    const auto previousTime = _animationTime;
+
+    _animationTime += deltaTime;
 
-    _rushSlot = channel->complete()->connect([=](SoundChannel::Ptr channel)
+    for (uint labelId = 0; labelId < _labels.size(); ++labelId)
     {
-        _dinoSymbol->removeComponent(sound);
-    });
+        const auto time = _labels[labelId].time;
+
+        if (time < _animationWindowStart || time > _animationWindowStop)
+            continue;
 
-    _dinoSymbol->addComponent(sound);
+        if (float(time) > previousTime && float(time) <= _animationTime)
+        {
+            animationLabelHit(labelId);
+
+            if (windowId != _animationWindowId || !_animationPlaying)
+                return;
+        }
+    }
+
+    if (_animationTime >= float(_animationWindowStop))
+        _animationTime = float(_animationWindowStart);
 }
+#endif
 
 void
-DinoScript::step()
+DinoScript::playSound(const std::string& filename, int priority)
 {
-    static PseudoRandom<std::string>::Ptr random = PseudoRandom<std::string>::create(_footStepSamples);
-    auto channel = _sceneManager->assets()->sound(random->next())->play(1);
+#ifndef TREX_HEADLESS
+    _car->voices()->play(_sceneManager->assets()->sound(filename), _dinoSymbol, priority);
+#endif
+}
 
-    if (!channel)
-        return;
+void
+DinoScript::attack()
+{
+    playSound(_attackRandom->next(), TREX_SOUND_PRIORITY_ATTACK);
+}
 
-    auto sound = audio::PositionalSound::create(channel, _car->camera());
-    sound->audibilityCurve(audibilityCurve);
+void
+DinoScript::roar()
+{
+    playSound(_roarRandom->next(), TREX_SOUND_PRIORITY_ROAR);
+}
 
-    _walkSlots[sound] = channel->complete()->connect([=](SoundChannel::Ptr channel)
-    {
-        _walkSlots.erase(sound);
-        _dinoSymbol->removeComponent(sound);
-    });
+void
+DinoScript::rush()
+{
+    playSound(_rushRandom->next(), TREX_SOUND_PRIORITY_RUSH);
+}
 
-    _dinoSymbol->addComponent(sound);
+void
+DinoScript::step()
+{
+    playSound(_footStepRandom->next(), TREX_SOUND_PRIORITY_STEP);
 }
 
 void
@@ -459,40 +430,57 @@ DinoScript::update(scene::Node::Ptr target)
     if (target != _target)
         return;
 
+    ++_frame;
+
     if (_car->gameStarted())
     {
-        if (_currentState == State::NONE)
+        if (_states->current() == int(State::NONE))
             changeCurrentState(State::SPAWNING);
 
         auto dz = (_speed / 3600.f) * deltaTime();
 
         _target->component<Transform>()->matrix()->appendTranslation(0.f, 0.f, dz);
+        _car->world()->invalidate(_worldSlot);
 
-        if (dinoIsActive())
+        // between two AI ticks, the dino keeps its last speed
+        auto carDistance = _car->world()->position(WorldCache::CAR).z - _car->world()->position(_worldSlot).z;
+
+        if (AiLod::ticks(_frame, _aiId, carDistance))
         {
-            if (_hadSameLaneAsCar && !hasSameLaneAsCar())
-            {
-                carExitedLane();
-            }
-            else if (!_hadSameLaneAsCar && hasSameLaneAsCar())
+            if (dinoIsActive())
             {
-                carEnteredLane();
+                if (_hadSameLaneAsCar && !hasSameLaneAsCar())
+                {
+                    carExitedLane();
+                }
+                else if (!_hadSameLaneAsCar && hasSameLaneAsCar())
+                {
+                    carEnteredLane();
+                }
+
+                _hadSameLaneAsCar = hasSameLaneAsCar();
             }
 
-            _hadSameLaneAsCar = hasSameLaneAsCar();
-        }
+            updateSpeed();
 
-        updateSpeed();
+            const auto currentTime = time();
 
-        updateState();
+            _states->update((currentTime - _currentTimeStamp) / 1000.0f);
+            _currentTimeStamp = currentTime;
+        }
     }
+
+#ifdef TREX_HEADLESS
+    updateAnimation(deltaTime() * _car->clock()->animationTimeScale());
+#else
+    updateAnimationLod();
+#endif
 }
 
 float
 DinoScript::distanceToCar()
 {
-    return (_car->getTarget(0)->component<Transform>()->modelToWorld(Vector3::create()) -
-            _target->component<Transform>()->modelToWorld(Vector3::create()))->length();
+    return _car->world()->distance(WorldCache::CAR, _worldSlot);
 }
 
 void
@@ -501,278 +489,249 @@ DinoScript::stop(scene::Node::Ptr)
     std::cout << "DinoScript stop" << std::endl;
 }
 
-float
-DinoScript::elapsedTime(const std::string& name) const
-{
-    return _timers.at(name);
+static const std::string STATE_NAMES[] = {
+    "NONE", "SPAWNING", "WALKING", "FOLLOWING", "SCREAMING", "ACCELERATING", "ATTACKING", "RECOVERING", "AAARGH"
+};
+
+void
+DinoScript::initStateMachine()
+{
+    _states = StateMachine::create(int(State::NUM_STATES), NUM_TIMERS, STATE_CHANGED, int(State::NONE));
+
+    for (auto state = 0; state < int(State::NUM_STATES); ++state)
+        _states->nameState(state, STATE_NAMES[state]);
+
+    _states->nameTimer(STATE_CHANGED, "stateChanged");
+    _states->nameTimer(CAR_ENTERED_LANE, "carEnteredLane");
+    _states->nameTimer(CAR_EXITED_LANE, "carExitedLane");
+    _states->nameTimer(ATTACK_ENDED, "attackEnded");
+
+    _states->nameCondition(WITHIN_DEFAULT_DISTANCE, "withinDefaultDistance");
+    _states->nameCondition(CLOSER_THAN, "closerThan");
+    _states->nameCondition(SAME_LANE_AS_CAR, "sameLaneAsCar");
+    _states->nameCondition(TIMER_ABOVE, "timerAbove");
+    _states->nameCondition(GOD_MODE, "godMode");
+
+    _states->nameAction(CAR_SPEED, "carSpeed");
+    _states->nameAction(SPEED, "speed");
+    _states->nameAction(SPAWN_SPEED, "spawnSpeed");
+    _states->nameAction(PLAY, "play");
+    _states->nameAction(WALK, "walk");
+    _states->nameAction(FOLLOW_CAR, "followCar");
+    _states->nameAction(ROAR, "roar");
+    _states->nameAction(RUSH, "rush");
+    _states->nameAction(ATTACK, "attack");
+    _states->nameAction(EAT, "eat");
+    _states->nameAction(SLOW_ANIMATION, "slowAnimation");
+    _states->nameAction(START_MUSIC, "startMusic");
+    _states->nameAction(LOCK_CAR_LANE, "lockCarLane");
+    _states->nameAction(UNLOCK_CAR_LANE, "unlockCarLane");
+    _states->nameAction(RESET_TIMER, "resetTimer");
+
+    _states->nameEvent(SCREAM_STOPPED, "screamStopped");
+    _states->nameEvent(ATTACK_STOPPED, "attackStopped");
+
+    _states->conditionFunction(std::bind(&DinoScript::checkCondition, this, std::placeholders::_1));
+    _states->actionFunction(std::bind(&DinoScript::runAction, this, std::placeholders::_1));
+
+    _stateChangedSlot = _states->changed()->connect([&](int previous, int current)
+    {
+        LOG_INFO("start " + STATE_NAMES[current]);
+    });
+
+    defaultStates();
 }
 
 void
-DinoScript::resetTimer(const std::string& name)
-{
-    _timers[name] = 0.0f;
+DinoScript::defaultStates()
+{
+    typedef StateMachine::Action    A;
+    typedef StateMachine::Guard     G;
+    typedef StateMachine::Transition T;
+
+    const auto none = StateMachine::NO_EVENT;
+    const auto walk = A { WALK, 0, 0.f, LABEL_DINO_FOOT_STEP_LEFT_START, LABEL_DINO_FOOT_STEP_RIGHT_STOP };
+
+    auto enter = [&](State state, const A& action) { _states->addEnterAction(int(state), action); };
+    auto exit = [&](State state, const A& action) { _states->addExitAction(int(state), action); };
+    auto transition = [&](State from, const T& t) { _states->addTransition(int(from), t); };
+    auto to = [](State state, int event, const std::vector<G>& guards) { return T { int(state), event, guards }; };
+
+    enter(State::SPAWNING, A { CAR_SPEED, 0, CAR_INTRO_SPEED });
+    enter(State::SPAWNING, A { SPAWN_SPEED, 0, TREX_DINO_INTRO_SPEED });
+    enter(State::SPAWNING, A { PLAY, 0, 0.f, LABEL_DINO_FOOT_STEP_LEFT_START, LABEL_DINO_FOOT_STEP_RIGHT_STOP });
+    exit(State::SPAWNING, A { CAR_SPEED, 0, CAR_BASE_SPEED });
+    exit(State::SPAWNING, A { START_MUSIC });
+    transition(State::SPAWNING, to(State::WALKING, none, { G { WITHIN_DEFAULT_DISTANCE } }));
+
+    enter(State::WALKING, A { SPEED, 0, TREX_DINO_BASE_SPEED });
+    enter(State::WALKING, walk);
+    transition(State::WALKING, to(State::FOLLOWING, none, {
+        G { SAME_LANE_AS_CAR, true },
+        G { TIMER_ABOVE, false, CAR_EXITED_LANE, TREX_DINO_FOLLOWING_STATE_DELAY }
+    }));
+    transition(State::WALKING, to(State::SCREAMING, none, {
+        G { SAME_LANE_AS_CAR },
+        G { TIMER_ABOVE, false, CAR_ENTERED_LANE, TREX_DINO_WALKING_TO_SCREAMING_STATE_DELAY },
+        G { TIMER_ABOVE, false, ATTACK_ENDED, TREX_DINO_AFTER_ATTACKING_WALKING_STATE_DURATION }
+    }));
+
+    enter(State::FOLLOWING, A { FOLLOW_CAR });
+    transition(State::FOLLOWING, to(State::WALKING, none, {
+        G { TIMER_ABOVE, false, STATE_CHANGED, LANE_CHANGE_DURATION / 1000.0f }
+    }));
+
+    enter(State::SCREAMING, A { PLAY, 0, 0.f, LABEL_DINO_SCREAM_START, LABEL_DINO_SCREAM_STOP });
+    enter(State::SCREAMING, A { ROAR });
+    transition(State::SCREAMING, to(State::ACCELERATING, SCREAM_STOPPED, { G { SAME_LANE_AS_CAR } }));
+    transition(State::SCREAMING, to(State::WALKING, SCREAM_STOPPED, { }));
+
+    enter(State::ACCELERATING, A { SPEED, 0, TREX_DINO_ACCELERATING_STATE_SPEED });
+    enter(State::ACCELERATING, A { PLAY, 0, 0.f, LABEL_DINO_RUN_START, LABEL_DINO_RUN_STOP });
+    enter(State::ACCELERATING, A { RUSH });
+    transition(State::ACCELERATING, to(State::ATTACKING, none, { G { CLOSER_THAN, false, 0, TREX_DINO_ATTACKING_DIST } }));
+
+    enter(State::ATTACKING, A { SPEED, 0, TREX_DINO_BASE_SPEED });
+    enter(State::ATTACKING, A { LOCK_CAR_LANE });
+    enter(State::ATTACKING, A { PLAY, 0, 0.f, LABEL_DINO_ATTACK_START, LABEL_DINO_ATTACK_STOP });
+    enter(State::ATTACKING, A { ATTACK });
+    exit(State::ATTACKING, A { UNLOCK_CAR_LANE });
+    exit(State::ATTACKING, A { RESET_TIMER, ATTACK_ENDED });
+    transition(State::ATTACKING, to(State::AAARGH, ATTACK_STOPPED, { G { SAME_LANE_AS_CAR }, G { GOD_MODE, true } }));
+    transition(State::ATTACKING, to(State::RECOVERING, ATTACK_STOPPED, { }));
+
+    enter(State::RECOVERING, A { PLAY, 0, 0.f, LABEL_DINO_FOOT_STEP_LEFT_START, LABEL_DINO_FOOT_STEP_RIGHT_STOP });
+    enter(State::RECOVERING, A { SPEED, 0, TREX_DINO_RECOVERING_STATE_SPEED });
+    transition(State::RECOVERING, to(State::WALKING, none, { G { WITHIN_DEFAULT_DISTANCE, true } }));
+
+    enter(State::AAARGH, A { EAT });
+    enter(State::AAARGH, A { PLAY, 0, 0.f, LABEL_DINO_EAT_START, LABEL_DINO_EAT_STOP });
+    enter(State::AAARGH, A { SLOW_ANIMATION });
 }
 
 void
-DinoScript::updateState()
+DinoScript::loadStates(const std::string& filename)
 {
-    const auto previousTime = _currentTimeStamp;
-    const auto currentTime = time();
+    // the file is optional: without it, the states of defaultStates() are kept
+    auto assets = _sceneManager->assets();
+    auto loader = file::Loader::create(assets->loader());
 
-    const auto dt = (currentTime - previousTime) / 1000.0f;
-
-    for (auto& timer : _timers)
-        timer.second += dt;
-
-    _currentTimeStamp = currentTime;
-
-    switch (_currentState)
+    _statesLoadedSlot = loader->complete()->connect([=](file::Loader::Ptr loader)
     {
-    case State::SPAWNING:
-
-        if (distanceToCar() > 0.0f && distanceToCar() <= requiredDistanceToCar(defaultDistanceToCar()))
-            changeCurrentState(State::WALKING);
-
-        break;
-
-    case State::WALKING:
-
-        if (!hasSameLaneAsCar() && elapsedTime("carExitedLane") > TREX_DINO_FOLLOWING_STATE_DELAY)
-        {
-            _wasFollowing = true;
-
-            changeCurrentState(State::FOLLOWING);
-        }
-        else if (hasSameLaneAsCar() &&
-                 elapsedTime("carEnteredLane") > TREX_DINO_WALKING_TO_SCREAMING_STATE_DELAY &&
-                 elapsedTime("dinoAttackEnded") > TREX_DINO_AFTER_ATTACKING_WALKING_STATE_DURATION)
-            changeCurrentState(State::SCREAMING);
-
-        break;
-
-    case State::FOLLOWING:
-
-        if (elapsedTime("stateChanged") > LANE_CHANGE_DURATION / 1000.0f)
-            changeCurrentState(State::WALKING);
-
-        break;
+        const auto& json = assets->blob(filename);
 
-    case State::SCREAMING:
-
-        break;
-
-    case State::ACCELERATING:
-
-        if (distanceToCar() < requiredDistanceToCar(TREX_DINO_ATTACKING_DIST))
-            changeCurrentState(State::ATTACKING);
-
-        break;
-
-    case State::ATTACKING:
-
-        break;
-
-    case State::RECOVERING:
+        if (_states->load(std::string(json.begin(), json.end())))
+            LOG_INFO("dino states loaded from " + filename);
+    });
+    _statesLoadErrorSlot = loader->error()->connect([=](file::Loader::Ptr loader, const file::Error& error)
+    {
+        _statesLoadedSlot = nullptr;
+    });
 
-        if (distanceToCar() > requiredDistanceToCar(defaultDistanceToCar()))
-            changeCurrentState(State::WALKING);
+    loader
+        ->queue(filename)
+        ->load();
+}
 
-        break;
+bool
+DinoScript::checkCondition(const StateMachine::Guard& guard)
+{
+    switch (guard.condition)
+    {
+    case WITHIN_DEFAULT_DISTANCE:
+    {
+        auto distance = distanceToCar();
 
+        return distance > 0.0f && distance <= requiredDistanceToCar(defaultDistanceToCar());
+    }
+    case CLOSER_THAN:
+        return distanceToCar() < requiredDistanceToCar(guard.value);
+    case SAME_LANE_AS_CAR:
+        return hasSameLaneAsCar();
+    case TIMER_ABOVE:
+        return _states->timer(guard.timer) > guard.value;
+    case GOD_MODE:
+        return TREX_GOD_MODE;
     default:
-        break;
+        return false;
     }
 }
 
 void
-DinoScript::startState(const State& state)
+DinoScript::runAction(const StateMachine::Action& action)
 {
-    switch (state)
+    switch (action.action)
     {
-    case State::SPAWNING:
-
-        _car->speed(CAR_INTRO_SPEED);
-        _requiredSpeed = TREX_DINO_INTRO_SPEED - std::min(_car->deltaSpeed(), 0.0f);
-
-        _dinoSkinnedNode->component<MasterAnimation>()
-            ->setPlaybackWindow(
-                LABEL_DINO_FOOT_STEP_LEFT_START,
-                LABEL_DINO_FOOT_STEP_RIGHT_STOP,
-                true
-            );
-
+    case CAR_SPEED:
+        _car->speed(action.value);
         break;
 
-    case State::WALKING:
+    case SPEED:
+        _requiredSpeed = action.value;
+        break;
 
-        LOG_INFO("start WALKING");
+    case SPAWN_SPEED:
+        _requiredSpeed = action.value - std::min(_car->deltaSpeed(), 0.0f);
+        break;
 
-        _requiredSpeed = TREX_DINO_BASE_SPEED;
+    case PLAY:
+        playAnimationWindow(action.startLabel, action.stopLabel);
+        break;
 
+    case WALK:
+        // coming back from FOLLOWING, the walk cycle is still playing
         if (!_wasFollowing)
-        {
-            _dinoSkinnedNode->component<MasterAnimation>()
-                ->setPlaybackWindow(
-                    LABEL_DINO_FOOT_STEP_LEFT_START,
-                    LABEL_DINO_FOOT_STEP_RIGHT_STOP,
-                    true
-            );
-        }
+            playAnimationWindow(action.startLabel, action.stopLabel);
         else
             _wasFollowing = false;
-
         break;
 
-    case State::FOLLOWING:
-
-        LOG_INFO("start FOLLOWING");
-
+    case FOLLOW_CAR:
+        _wasFollowing = true;
         followCar();
-
         break;
 
-    case State::SCREAMING:
-
-         LOG_INFO("start SCREAMING");
-
-        _dinoSkinnedNode->component<MasterAnimation>()
-            ->setPlaybackWindow(
-                LABEL_DINO_SCREAM_START,
-                LABEL_DINO_SCREAM_STOP,
-                true
-        );
-
-         roar();
-
+    case ROAR:
+        roar();
         break;
 
-    case State::ACCELERATING:
-
-        LOG_INFO("start ACCELERATING");
-
-        _requiredSpeed = TREX_DINO_ACCELERATING_STATE_SPEED;
-
-        _dinoSkinnedNode->component<MasterAnimation>()
-            ->setPlaybackWindow(
-                LABEL_DINO_RUN_START,
-                LABEL_DINO_RUN_STOP,
-                true
-            );
-
+    case RUSH:
         rush();
-
         break;
 
-    case State::ATTACKING:
-
-        LOG_INFO("start ATTACKING");
-
-        _requiredSpeed = TREX_DINO_BASE_SPEED;
-
-        _car->lockLane(_lane, true);
-
-        _dinoSkinnedNode->component<MasterAnimation>()
-            ->setPlaybackWindow(
-                LABEL_DINO_ATTACK_START,
-                LABEL_DINO_ATTACK_STOP,
-                true
-            );
-
+    case ATTACK:
         attack();
-
-        break;
-
-    case State::RECOVERING:
-
-        LOG_INFO("start RECOVERING");
-
-        _dinoSkinnedNode->component<MasterAnimation>()
-            ->setPlaybackWindow(
-                LABEL_DINO_FOOT_STEP_LEFT_START,
-                LABEL_DINO_FOOT_STEP_RIGHT_STOP,
-                true
-            );
-
-        _requiredSpeed = TREX_DINO_RECOVERING_STATE_SPEED;
-
         break;
 
-    case State::AAARGH:
-
+    case EAT:
         eat();
-
-        _dinoSkinnedNode->component<MasterAnimation>()
-            ->setPlaybackWindow(
-                LABEL_DINO_EAT_START,
-                LABEL_DINO_EAT_STOP,
-                true
-            )->isLooping(true);
-
-
-        _dinoSkinnedNode->component<MasterAnimation>()
-            ->timeFunction(gameOverTimeFunction);
-
         break;
 
-    default:
+    case SLOW_ANIMATION:
+#ifndef TREX_HEADLESS
+        _dinoSkinnedNode->component<MasterAnimation>()
+            ->isLooping(true);
+#endif
+        _car->clock()->animationTimeScale(TREX_GAME_OVER_ANIMATION_SCALE);
         break;
-    }
-}
-
-void
-DinoScript::stopState(const State& state)
-{
-    switch (state)
-    {
-    case State::SPAWNING:
-    {
-        LOG_INFO("stop spawning");
-
-        _car->speed(CAR_BASE_SPEED);
 
+    case START_MUSIC:
+#ifndef TREX_HEADLESS
         _music = _sceneManager->assets()->sound("sound/music.ogg")->play(0);
         _music->transform(SoundTransform::create(.4f));
-
-        break;
-    }
-    case State::WALKING:
-
-        LOG_INFO("stop WALKING");
-
-        break;
-
-    case State::FOLLOWING:
-
-        LOG_INFO("stop FOLLOWING");
-
+#endif
         break;
 
-    case State::SCREAMING:
-
-         LOG_INFO("stop SCREAMING");
-
-        break;
-
-    case State::ACCELERATING:
-
-        LOG_INFO("stop ACCELERATING");
-
+    case LOCK_CAR_LANE:
+        _car->lockLane(_lane, true);
         break;
 
-    case State::ATTACKING:
-
-        LOG_INFO("stop ATTACKING");
-
+    case UNLOCK_CAR_LANE:
         _car->lockLane(_lane, false);
-
-        resetTimer("dinoAttackEnded");
-
         break;
 
-    case State::RECOVERING:
-
-        LOG_INFO("stop RECOVERING");
-
+    case RESET_TIMER:
+        _states->resetTimer(action.timer);
         break;
 
     default:
@@ -781,20 +740,10 @@ DinoScript::stopState(const State& state)
 }
 
 void
-DinoScript::changeCurrentState(const State& state)
+DinoScript::changeCurrentState(State state)
 {
-    if (state == _currentState)
-        return;
-
-    stopState(_currentState);
-
-    _currentState = state;
-
-    startState(state);
-
-    resetTimer("stateChanged");
+    _states->change(int(state));
 }
-
 bool
 DinoScript::hasSameLaneAsCar() const
 {
@@ -811,11 +760,7 @@ DinoScript::followCar()
     _lane = lane() + deltaLane;
 
     if (deltaLane != 0)
-    {
-        std::string laneChange = std::to_string(_lane - deltaLane) + "to" + std::to_string(_lane);
-
-        _dinoLaneAnimation->stop()->setPlaybackWindow(laneChange + "_start", laneChange + "_end")->seek(laneChange + "_start")->play();
-    }
+        _laneMotion->moveTo(_lane);
 }
 
 void
@@ -823,7 +768,7 @@ DinoScript::carEnteredLane()
 {
     LOG_INFO("car entered lane");
 
-    resetTimer("carEnteredLane");
+    _states->resetTimer(CAR_ENTERED_LANE);
 }
 
 void
@@ -831,7 +776,7 @@ DinoScript::carExitedLane()
 {
     LOG_INFO("car exited lane");
 
-    resetTimer("carExitedLane");
+    _states->resetTimer(CAR_EXITED_LANE);
 }
 
 float
@@ -868,23 +813,7 @@ DinoScript::eat()
     
     _requiredSpeed = 0.0f;
 
-    static Signal<SoundChannel::Ptr>::Slot _eatSlot;
-    static PseudoRandom<std::string>::Ptr random = PseudoRandom<std::string>::create(_eatSamples);
-
-    auto channel = _sceneManager->assets()->sound("sound/trex_eat.ogg")->play(1);
-
-    if (!channel)
-        return;
-
-    auto sound = audio::PositionalSound::create(channel, _car->camera());
-    sound->audibilityCurve(audibilityCurve);
-
-    _eatSlot = channel->complete()->connect([=](SoundChannel::Ptr channel)
-    {
-        _dinoSymbol->removeComponent(sound);
-    });
-
-    _dinoSymbol->addComponent(sound);
+    playSound(_eatSamples.front(), TREX_SOUND_PRIORITY_EAT);
 }
 
 void
@@ -893,8 +822,12 @@ DinoScript::gameOver()
     if (_gameIsOver)
         return;
 
+#ifdef TREX_HEADLESS
+    _animationPlaying = false;
+#else
     _dinoSkinnedNode->component<MasterAnimation>()
         ->stop();
+#endif
 
     _gameIsOver = true;
 
@@ -905,14 +838,39 @@ DinoScript::gameOver()
     _target->component<Transform>()->matrix()->copyFrom(Matrix4x4::create());
 }
 
-uint
-DinoScript::gameOverTimeFunction(uint time)
+void
+DinoScript::updateAnimationLod()
 {
-    static uint firstCalledAt = time;
+    // the camera follows the head while eating: the animation must stay smooth
+    if (_isEating)
+    {
+        _animationStep = 1;
 
-    auto diff = time - firstCalledAt;
+        return;
+    }
+
+    auto distance = _car->world()->distance(WorldCache::CAR, _worldSlot);
+    auto screenSize = distance > 0.f
+        ? TREX_DINO_HEIGHT / (2.f * distance * std::tan(TREX_CAMERA_FOV / 2.f))
+        : 1.f;
+
+    if (distance > TREX_FOG_END || screenSize < TREX_ANIMATION_LOD_HALF_SIZE)
+        _animationStep = TREX_ANIMATION_LOD_LOW_STEP;
+    else if (screenSize < TREX_ANIMATION_LOD_FULL_SIZE)
+        _animationStep = TREX_ANIMATION_LOD_HALF_STEP;
+    else
+        _animationStep = 1;
+}
 
-    time = firstCalledAt + int(diff / 3.f);
+uint
+DinoScript::animationTime(uint time)
+{
+    time = uint(_car->clock()->animationTime(time));
 
-    return time;
-}
\ No newline at end of file
+    // the pose only changes, and the skin is only updated, once per step; the returned
+    // time never goes back when the step changes
+    if (time < _sampledAnimationTime || time >= _sampledAnimationTime + _animationStep)
+        _sampledAnimationTime = time;
+
+    return _sampledAnimationTime;
+}
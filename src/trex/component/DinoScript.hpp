@@ -21,6 +21,11 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 
 #include "minko/Minko.hpp"
 
+#include "trex/PseudoRandom.hpp"
+#include "trex/StateMachine.hpp"
+#include "trex/WorldCache.hpp"
+#include "trex/component/LaneMotion.hpp"
+
 namespace trex
 {
     namespace component
@@ -40,12 +45,18 @@ namespace trex
 
         private:
             typedef minko::scene::Node::Ptr                                                         NodePtr;
+            typedef std::shared_ptr<CarScript>                                                      CarScriptPtr;
+            typedef PseudoRandom<std::string>::Ptr                                                  SampleRandomPtr;
 
             typedef minko::audio::SoundChannel::Ptr                                                 SoundChannelPtr;
             typedef minko::component::SceneManager::Ptr                                             SceneManagerPtr;
             typedef minko::component::Animation::Ptr                                                AnimationPtr;
             typedef minko::component::AbstractAnimation::Ptr                                        AbstractAnimationPtr;
             typedef minko::Signal<AbstractAnimationPtr, std::string, minko::uint>::Slot             AnimationLabelHitSlot;
+            typedef minko::Signal<float>::Slot                                                      OriginShiftedSlot;
+            typedef minko::Signal<int, int>::Slot                                                   StateChangedSlot;
+            typedef minko::Signal<minko::file::Loader::Ptr>::Slot                                   LoaderCompleteSlot;
+            typedef minko::Signal<minko::file::Loader::Ptr, const minko::file::Error&>::Slot        LoaderErrorSlot;
 
             enum class State
             {
@@ -57,7 +68,68 @@ namespace trex
                 ACCELERATING,
                 ATTACKING,
                 RECOVERING,
-                AAARGH
+                AAARGH,
+                NUM_STATES
+            };
+
+            enum Timer
+            {
+                STATE_CHANGED,
+                CAR_ENTERED_LANE,
+                CAR_EXITED_LANE,
+                ATTACK_ENDED,
+                NUM_TIMERS
+            };
+
+            enum Condition
+            {
+                WITHIN_DEFAULT_DISTANCE,
+                CLOSER_THAN,
+                SAME_LANE_AS_CAR,
+                TIMER_ABOVE,
+                GOD_MODE
+            };
+
+            enum Action
+            {
+                CAR_SPEED,
+                SPEED,
+                SPAWN_SPEED,
+                PLAY,
+                WALK,
+                FOLLOW_CAR,
+                ROAR,
+                RUSH,
+                ATTACK,
+                EAT,
+                SLOW_ANIMATION,
+                START_MUSIC,
+                LOCK_CAR_LANE,
+                UNLOCK_CAR_LANE,
+                RESET_TIMER
+            };
+
+            enum Event
+            {
+                SCREAM_STOPPED,
+                ATTACK_STOPPED
+            };
+
+            enum class LabelAction
+            {
+                NONE,
+                STEP,
+                SCREAM_STOP,
+                ATTACK_STOP,
+                EAT_MOVE_CAMERA,
+                EAT_GAME_OVER
+            };
+
+            struct Label
+            {
+                std::string     name;
+                minko::uint     time;
+                LabelAction     action;
             };
 
         private:
@@ -66,14 +138,17 @@ namespace trex
             NodePtr                                     _dinoSymbol;
             float                                       _speed;
             float                                       _requiredSpeed;
-            State                                       _currentState;
+            StateMachine::Ptr                           _states;
+            StateChangedSlot                            _stateChangedSlot;
+            LoaderCompleteSlot                          _statesLoadedSlot;
+            LoaderErrorSlot                             _statesLoadErrorSlot;
             float                                       _currentTimeStamp;
-            std::shared_ptr<CarScript>                  _car;
+            CarScriptPtr                                _car;
             int                                         _lane;
             minko::math::Matrix4x4::Ptr                 _destinationMatrix;
-            std::map<std::string, float>                _timers;
             bool                                        _hadSameLaneAsCar;
             AnimationLabelHitSlot                       _dinoFootStepLabelHitSlot;
+            OriginShiftedSlot                           _originShiftedSlot;
 
             static
             std::vector<std::string>                    _eatSamples;
@@ -95,24 +170,44 @@ namespace trex
             NodePtr                                     _dinoLaneAnimatedNode;
             NodePtr                                     _dinoSkinnedNode;
             NodePtr                                     _headDummyNode;
-            AnimationPtr                                _dinoLaneAnimation;
-            AnimationLabelHitSlot                       _dinoLaneAnimationLabelHit;
+            LaneMotion::Ptr                             _laneMotion;
 
             std::shared_ptr<minko::audio::SoundChannel> _music;
 
             bool                                        _wasFollowing; // hack
             bool                                        _isEating;
             bool                                        _gameIsOver;
+            minko::uint                                 _animationStep;
+            minko::uint                                 _sampledAnimationTime;
+
+            SampleRandomPtr                             _footStepRandom;
+            SampleRandomPtr                             _roarRandom;
+            SampleRandomPtr                             _attackRandom;
+            SampleRandomPtr                             _rushRandom;
+
+            // label ids sharing a time, so that a hit is resolved without comparing names
+            std::unordered_map<minko::uint, std::vector<minko::uint>>   _labelsAtTime;
+            minko::uint                                 _frame;
+            minko::uint                                 _lastLabelTime;
+            minko::uint                                 _lastLabelFrame;
+            WorldCache::Slot                            _worldSlot;
+            // spreads the AI ticks of the dinos over the AiLod periods
+            minko::uint                                 _aiId;
 
-        public:
             static
-            std::map<
-                minko::audio::PositionalSound::Ptr,
-                minko::Signal<SoundChannelPtr>::Slot
-            >                                           _walkSlots;
+            minko::uint                                 _numInstances;
+
+#ifdef TREX_HEADLESS
+            minko::uint                                 _animationWindowStart;
+            minko::uint                                 _animationWindowStop;
+            minko::uint                                 _animationWindowId;
+            float                                       _animationTime;
+            bool                                        _animationPlaying;
+#endif
 
+        public:
             static
-            std::map<std::string, minko::uint>          _labels;
+            std::vector<Label>                          _labels;
 
         public:
             ~DinoScript()
@@ -121,9 +216,9 @@ namespace trex
 
             static
             Ptr
-            create(NodePtr root)
+            create(NodePtr root, CarScriptPtr car)
             {
-                auto script = std::shared_ptr<DinoScript>(new DinoScript(root));
+                auto script = std::shared_ptr<DinoScript>(new DinoScript(root, car));
 
                 script->initialize();
 
@@ -147,7 +242,7 @@ namespace trex
             stop(std::shared_ptr<minko::scene::Node> target);
 
         private:
-            DinoScript(NodePtr);
+            DinoScript(NodePtr root, CarScriptPtr car);
 
             void
             initDinoSymbol();
@@ -155,26 +250,44 @@ namespace trex
             void
             initDinoLaneAnimation();
 
+            void
+            labelsHit(minko::uint time);
+
+            void
+            animationLabelHit(minko::uint labelId);
+
+            static
+            minko::uint
+            labelTime(const std::string& name);
+
+            void
+            playAnimationWindow(const std::string& startLabel, const std::string& stopLabel);
+
+#ifdef TREX_HEADLESS
+            void
+            updateAnimation(float deltaTime);
+#endif
+
             float
             distanceToCar();
 
             void
-            updateState();
+            initStateMachine();
 
             void
-            changeCurrentState(const State& state);
+            defaultStates();
 
             void
-            startState(const State& state);
+            loadStates(const std::string& filename);
 
-            void
-            stopState(const State& state);
+            bool
+            checkCondition(const StateMachine::Guard& guard);
 
-            float
-            elapsedTime(const std::string& name) const;
+            void
+            runAction(const StateMachine::Action& action);
 
             void
-            resetTimer(const std::string& name);
+            changeCurrentState(State state);
 
             inline
             int
@@ -201,6 +314,9 @@ namespace trex
             void
             step();
 
+            void
+            playSound(const std::string& filename, int priority);
+
             void
             carEnteredLane();
 
@@ -226,9 +342,11 @@ namespace trex
             void
             eat();
 
-            static
+            void
+            updateAnimationLod();
+
             minko::uint
-            gameOverTimeFunction(minko::uint time);
+            animationTime(minko::uint time);
         };
     }
 }
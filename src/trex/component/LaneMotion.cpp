@@ -0,0 +1,94 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "LaneMotion.hpp"
+
+using namespace minko;
+using namespace minko::component;
+using namespace trex::component;
+
+LaneMotion::LaneMotion(int lane, float duration) :
+    _duration(duration),
+    _lane(lane),
+    _destinationLane(lane),
+    _fromX(laneX(lane)),
+    _toX(laneX(lane)),
+    _peakYaw(0.f),
+    _time(0.f),
+    _moving(false),
+    _entered(false),
+    _event(EventSignal::create())
+{
+}
+
+float
+LaneMotion::x() const
+{
+    return _fromX + (_toX - _fromX) * std::min(_time / _duration, 1.f);
+}
+
+void
+LaneMotion::moveTo(int lane)
+{
+    if (lane == _destinationLane && _moving)
+        return;
+
+    _fromX = x();
+    _toX = laneX(lane);
+    _destinationLane = lane;
+    _peakYaw = std::abs(lane - _lane) > 1 ? FAR_LANE_YAW : ADJACENT_LANE_YAW;
+    if (_toX < _fromX)
+        _peakYaw = -_peakYaw;
+    _time = 0.f;
+    _moving = true;
+    _entered = false;
+
+    _event->execute(std::static_pointer_cast<LaneMotion>(shared_from_this()), Event::STARTED, _lane);
+}
+
+void
+LaneMotion::update(scene::Node::Ptr target)
+{
+    if (!_moving)
+        return;
+
+    auto self = std::static_pointer_cast<LaneMotion>(shared_from_this());
+
+    _time += deltaTime();
+
+    auto t = std::min(_time / _duration, 1.f);
+
+    target->component<Transform>()->matrix()
+        ->identity()
+        ->appendRotationY(_peakYaw * std::sin(float(M_PI) * t))
+        ->appendTranslation(x(), 0.f, 0.f);
+
+    if (!_entered && t >= .5f)
+    {
+        _entered = true;
+        _lane = _destinationLane;
+        _event->execute(self, Event::ENTERED, _lane);
+    }
+
+    if (t >= 1.f)
+    {
+        _moving = false;
+        _event->execute(self, Event::ARRIVED, _lane);
+    }
+}
@@ -0,0 +1,115 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    namespace component
+    {
+        // Moves its target from lane to lane: the x position is interpolated linearly over
+        // the duration of the change and the yaw follows a sine arc, peaking halfway.
+        class LaneMotion : public minko::component::AbstractScript
+        {
+        public:
+            typedef std::shared_ptr<LaneMotion>     Ptr;
+
+            enum class Event
+            {
+                STARTED,    // the target left its lane
+                ENTERED,    // the target is halfway, in the destination lane
+                ARRIVED     // the target is centered on the destination lane
+            };
+
+            typedef minko::Signal<Ptr, Event, int>  EventSignal;
+
+        private:
+            float               _duration;
+            int                 _lane;
+            int                 _destinationLane;
+            float               _fromX;
+            float               _toX;
+            float               _peakYaw;
+            float               _time;
+            bool                _moving;
+            bool                _entered;
+            EventSignal::Ptr    _event;
+
+        public:
+            static
+            Ptr
+            create(int lane, float duration = LANE_CHANGE_DURATION)
+            {
+                auto motion = std::shared_ptr<LaneMotion>(new LaneMotion(lane, duration));
+
+                motion->initialize();
+
+                return motion;
+            }
+
+            static
+            inline
+            float
+            laneX(int lane)
+            {
+                return float((NUM_LANES - 1) / 2 - lane) * LANE_WIDTH;
+            }
+
+            // The lane the target is in: the destination lane once halfway there.
+            inline
+            int
+            lane() const
+            {
+                return _lane;
+            }
+
+            inline
+            bool
+            isMoving() const
+            {
+                return _moving;
+            }
+
+            inline
+            EventSignal::Ptr
+            event() const
+            {
+                return _event;
+            }
+
+            // Starts a lane change from the current position, interrupting the current one.
+            void
+            moveTo(int lane);
+
+        protected:
+            void
+            update(minko::scene::Node::Ptr target);
+
+        private:
+            LaneMotion(int lane, float duration);
+
+            float
+            x() const;
+        };
+    }
+}
@@ -0,0 +1,61 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "LodSwitch.hpp"
+
+using namespace minko;
+using namespace trex::component;
+
+LodSwitch::Ptr
+LodSwitch::addLevel(float maxDistance, scene::Node::Ptr node)
+{
+    _levels.push_back({ maxDistance, node });
+
+    // the level is attached by the first call to update()
+    _level = _levels.size();
+
+    return std::static_pointer_cast<LodSwitch>(shared_from_this());
+}
+
+void
+LodSwitch::update(float distance)
+{
+    if (targets().empty())
+        return;
+
+    auto level = _level;
+    const auto numLevels = _levels.size();
+
+    while (level < numLevels && distance >= _levels[level].maxDistance + _hysteresis)
+        ++level;
+    while (level > 0 && distance < _levels[level - 1].maxDistance - _hysteresis)
+        --level;
+
+    if (level == _level)
+        return;
+
+    auto target = targets().front();
+
+    if (_level < numLevels && _levels[_level].node->parent() == target)
+        target->removeChild(_levels[_level].node);
+    if (level < numLevels)
+        target->addChild(_levels[level].node);
+
+    _level = level;
+}
@@ -0,0 +1,82 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    namespace component
+    {
+        // Keeps one of several levels of detail attached to its target according to a
+        // distance given by update(). Level i is used while the distance is lower than its
+        // maximum distance; past the last level, nothing is attached. A level only changes
+        // once the distance crossed its bound by more than the hysteresis, so that a model
+        // does not pop back and forth around a bound.
+        class LodSwitch : public minko::component::AbstractComponent
+        {
+        public:
+            typedef std::shared_ptr<LodSwitch>  Ptr;
+
+        private:
+            struct Level
+            {
+                float                   maxDistance;
+                minko::scene::Node::Ptr node;
+            };
+
+        private:
+            std::vector<Level>  _levels;
+            float               _hysteresis;
+            unsigned int        _level;
+
+        public:
+            static
+            Ptr
+            create(float hysteresis = TREX_LOD_HYSTERESIS)
+            {
+                return std::shared_ptr<LodSwitch>(new LodSwitch(hysteresis));
+            }
+
+            // Levels must be added from the closest to the farthest one.
+            Ptr
+            addLevel(float maxDistance, minko::scene::Node::Ptr node);
+
+            void
+            update(float distance);
+
+            inline
+            unsigned int
+            level() const
+            {
+                return _level;
+            }
+
+        private:
+            LodSwitch(float hysteresis) :
+                _hysteresis(hysteresis),
+                _level(0)
+            {
+            }
+        };
+    }
+}
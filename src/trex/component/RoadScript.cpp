@@ -28,6 +28,18 @@ using namespace minko::component;
 using namespace minko::audio;
 using namespace trex::component;
 
+static
+scene::Node::Ptr
+loadSymbol(file::AssetLibrary::Ptr assets, const std::string& name)
+{
+#ifdef TREX_HEADLESS
+    // No asset is loaded by the simulation: an empty node stands for the model.
+    return scene::Node::create(name)->addComponent(Transform::create());
+#else
+    return assets->symbol(name);
+#endif
+}
+
 void
 RoadScript::initialize()
 {
@@ -46,20 +58,41 @@ RoadScript::start(scene::Node::Ptr target)
     initializeProps(sceneManager->assets());
     initializeGround(sceneManager->assets());
 
+    _obstacleIndex = ObstacleIndex::create(TREX_CHUNK_POOL_SIZE);
+    _chunkGenerator = ChunkGenerator::create(std::rand());
+#ifdef TREX_ENABLE_CHUNK_MERGING
+    _meshMerger = MeshMerger::create(sceneManager->assets()->context());
+#endif
+    _chunks.resize(TREX_CHUNK_POOL_SIZE);
+
+    _originShiftedSlot = _car->component<CarScript>()->originShifted()->connect([&](float shift)
+    {
+        shiftOrigin(shift);
+    });
+
     for (int i = 0; i < TREX_CHUNK_POOL_SIZE; i++)
     {
-        auto chunk = scene::Node::create();
-        initializeChunk(chunk, sceneManager->assets());
+        auto& chunk = _chunks[i];
+        ChunkLayout layout;
+
+        _chunkGenerator->next(layout, true);
+
+        chunk.node = scene::Node::create();
+        initializeChunk(chunk, layout);
 
 #ifdef ROAD_COLLISION_ENABLE
-        createObstacle(sceneManager, i);
-        chunk->addChild(_obstacles[i]);
+        for (auto obstacleId = 0; obstacleId < TREX_ROAD_CHUNK_MAX_OBSTACLES; ++obstacleId)
+        {
+            createObstacle(chunk);
+            placeObstacle(chunk, obstacleId);
+        }
+
+        indexChunkObstacles(i);
 #endif
 
-        chunk->addComponent(Transform::create());
-        _stockChunks.push_back(chunk);
-        target->addChild(chunk);
-        chunk->component<Transform>()->matrix()->appendTranslation(0.f, -50.f, 0.f);
+        // stock chunks stay out of the scene graph until addFrontChunk() activates them
+        chunk.node->addComponent(Transform::create());
+        _chunkRing.push_back({ chunk.node, i, 0.f });
     }
 }
 
@@ -67,7 +100,7 @@ void
 RoadScript::initializeGround(minko::file::AssetLibrary::Ptr assets)
 {
     auto fx = assets->effect("effect/Phong.effect");
-    _ground = assets->symbol(TREX_ROAD_MAP);
+    _ground = loadSymbol(assets, TREX_ROAD_MAP);
 
     _ground->component<Transform>()->matrix()
         ->appendTranslation(0.f, 0.f, (float)TREX_ROAD_CHUNK_LENGTH / 2.f);
@@ -76,17 +109,20 @@ RoadScript::initializeGround(minko::file::AssetLibrary::Ptr assets)
 void
 RoadScript::initializeProps(minko::file::AssetLibrary::Ptr assets)
 {
-    _props.push_back(assets->symbol("model/map_block_a.scene"));
-    _props.push_back(assets->symbol("model/map_block_b.scene"));
-    _props.push_back(assets->symbol("model/map_block_c.scene"));
-    _props.push_back(assets->symbol("model/map_block_d.scene"));
-    _props.push_back(assets->symbol("model/map_block_e.scene"));
-    _trunkModels.push_back(assets->symbol("model/item_trunk_a.scene"));
-    _trunkModels.push_back(assets->symbol("model/item_trunk_b.scene"));
-    _trunkModels.push_back(assets->symbol("model/item_trunk_c.scene"));
-    _trunkModels.push_back(assets->symbol("model/item_trunk_d.scene"));
-    _lightWell = assets->symbol("model/misc_lightwell.scene");
-    _lianaModel = assets->symbol("model/item_liana.scene");
+    _props.push_back(loadSymbol(assets, "model/map_block_a.scene"));
+    _props.push_back(loadSymbol(assets, "model/map_block_b.scene"));
+    _props.push_back(loadSymbol(assets, "model/map_block_c.scene"));
+    _props.push_back(loadSymbol(assets, "model/map_block_d.scene"));
+    _props.push_back(loadSymbol(assets, "model/map_block_e.scene"));
+    _trunkModels.push_back(loadSymbol(assets, "model/item_trunk_a.scene"));
+    _trunkModels.push_back(loadSymbol(assets, "model/item_trunk_b.scene"));
+    _trunkModels.push_back(loadSymbol(assets, "model/item_trunk_c.scene"));
+    _trunkModels.push_back(loadSymbol(assets, "model/item_trunk_d.scene"));
+    _lightWell = loadSymbol(assets, "model/misc_lightwell.scene");
+    _lianaModel = loadSymbol(assets, "model/item_liana.scene");
+
+    for (auto trunk : _trunkModels)
+        _trunkSkins.push_back(createSkin(trunk));
 
     for (auto prop : _props)
     {
@@ -104,8 +140,14 @@ RoadScript::initializeProps(minko::file::AssetLibrary::Ptr assets)
             material->set("normalMap", assets->texture("texture/map_block_nrm.jpg"));
             material->set("alphaMap", assets->texture("texture/map_block_alpha.jpg"));
         }
+
+        _propSkins.push_back(createSkin(prop));
     }
 
+#ifdef TREX_ENABLE_IMPOSTORS
+    bakeImpostors(assets);
+#endif
+
 #ifdef TREX_ENABLE_LIGHTWELL
     auto lightsNodes = scene::NodeSet::create(_lightWell)
         ->descendants(false)
@@ -136,119 +178,458 @@ RoadScript::initializeProps(minko::file::AssetLibrary::Ptr assets)
 }
 
 void
-RoadScript::initializeChunk(minko::scene::Node::Ptr chunk, minko::file::AssetLibrary::Ptr assets)
+RoadScript::initializeChunk(Chunk& chunk, const ChunkLayout& layout)
 {
-    chunk->addChild(_ground->clone(CloneOption::SHALLOW));
-    srand(static_cast<unsigned int>(std::time(NULL)));
-
-    auto leftSide = scene::Node::create("left");
-    chunk->addChild(leftSide);
-    leftSide->addComponent(Transform::create());
-    initializeChunkSide(leftSide, 0);
+    chunk.node->addChild(_ground->clone(CloneOption::SHALLOW));
+    chunk.layout = layout;
+    chunk.mergedSignatures.fill(-1);
 
-    auto rightSide = scene::Node::create("right");
-    initializeChunkSide(rightSide, 1);
-    rightSide->addComponent(Transform::create());
+    for (auto side = 0; side < 2; ++side)
+    {
+        chunk.sides[side] = scene::Node::create(side == 0 ? "left" : "right")
+            ->addComponent(Transform::create());
+        initializeChunkSide(chunk, side, layout);
+
+#ifdef TREX_ENABLE_IMPOSTORS
+        chunk.sideLods[side] = createLodSwitch(chunk.node, chunk.sides[side], TREX_IMPOSTOR_DISTANCE)
+            ->addLevel(TREX_FOG_END, chunk.impostorSides[side]);
+#else
+        chunk.sideLods[side] = createLodSwitch(chunk.node, chunk.sides[side], TREX_FOG_END);
+#endif
+    }
 
 #ifdef TREX_ENABLE_LIGHTWELL
-    auto locallightWell = _lightWell->clone(CloneOption::SHALLOW);
-    auto liana = _lianaModel->clone(CloneOption::SHALLOW);
+    chunk.lightWell = _lightWell->clone(CloneOption::SHALLOW);
+    chunk.liana = _lianaModel->clone(CloneOption::SHALLOW);
 
-    locallightWell->component<Transform>()->matrix()->appendTranslation(
-        static_cast<float>(rand() % 5),
+    chunk.lightWell->component<Transform>()->matrix()->appendTranslation(
+        layout.lightWellX,
         0,
-        static_cast<float>(rand() % 100)
+        layout.lightWellZ
     );
-    liana->component<Transform>()->matrix()
-        ->appendTranslation(0.f, -5.f, 0.f);
-    rightSide->addChild(locallightWell);
-    leftSide->addChild(liana);
+    chunk.liana->component<Transform>()->matrix()
+        ->appendTranslation(0.f, -5.f, layout.lianaZ);
+    chunk.decorationLods.push_back(createLodSwitch(chunk.node, chunk.lightWell, TREX_FOG_END));
+    chunk.decorationLods.push_back(createLodSwitch(chunk.node, chunk.liana, TREX_FOG_END));
 #endif
+}
+
+void
+RoadScript::initializeChunkSide(Chunk& chunk, int index, const ChunkLayout& layout)
+{
+    auto side = chunk.sides[index];
 
-    chunk->addChild(rightSide);
+#ifdef TREX_ENABLE_IMPOSTORS
+    chunk.impostorSides[index] = scene::Node::create("impostors")->addComponent(Transform::create());
+
+    for (auto propId = 0; propId < TREX_ROAD_CHUNK_NUM_PROPS; ++propId)
+    {
+        chunk.impostors[index][propId] = createImpostorSlot();
+        chunk.impostorSides[index]->addChild(chunk.impostors[index][propId]);
+    }
+#endif
+
+    for (auto propId = 0; propId < TREX_ROAD_CHUNK_NUM_PROPS; ++propId)
+    {
+        auto prop = createSkinSlot(_propSkins);
+
+        chunk.props[index][propId] = prop;
+        placeProp(chunk, index, propId);
+
+        side->addChild(prop);
+    }
+
+    mergeChunkSide(chunk, index);
+}
+
+RoadScript::ModelSkin
+RoadScript::createSkin(scene::Node::Ptr symbol)
+{
+    ModelSkin skin;
+
+    skin.matrix = Matrix4x4::create()->copyFrom(symbol->component<Transform>()->matrix());
+
+    auto surfaceNodes = scene::NodeSet::create(symbol)
+        ->descendants(false)
+        ->where([](scene::Node::Ptr n)
+    {
+        return n->hasComponent<Surface>();
+    });
+
+    for (auto node : surfaceNodes->nodes())
+    {
+        // matrix of the surface in the space of the symbol root
+        auto matrix = Matrix4x4::create();
+
+        for (auto n = node; n != symbol; n = n->parent())
+            if (n->hasComponent<Transform>())
+                matrix->append(n->component<Transform>()->matrix());
+
+        auto surface = node->component<Surface>();
+
+        skin.parts.push_back({ surface->geometry(), surface->material(), surface->effect(), matrix });
+    }
+
+    return skin;
+}
+
+scene::Node::Ptr
+RoadScript::createSkinSlot(const std::vector<ModelSkin>& skins)
+{
+    auto slot = scene::Node::create()->addComponent(Transform::create());
+    const ModelSkin* largestSkin = nullptr;
+
+    for (const auto& skin : skins)
+        if (largestSkin == nullptr || skin.parts.size() > largestSkin->parts.size())
+            largestSkin = &skin;
+
+    if (largestSkin == nullptr)
+        return slot;
+
+    for (const auto& part : largestSkin->parts)
+    {
+        slot->addChild(scene::Node::create()
+            ->addComponent(Transform::create())
+            ->addComponent(Surface::create(part.geometry, part.material, part.effect))
+        );
+    }
+
+    return slot;
+}
+
+void
+RoadScript::applySkin(scene::Node::Ptr slot, const ModelSkin& skin)
+{
+    const auto& partNodes = slot->children();
+
+    slot->component<Transform>()->matrix()->copyFrom(skin.matrix);
+
+    for (unsigned int partId = 0; partId < partNodes.size(); ++partId)
+    {
+        auto surface = partNodes[partId]->component<Surface>();
+
+        if (partId < skin.parts.size())
+        {
+            const auto& part = skin.parts[partId];
+
+            partNodes[partId]->component<Transform>()->matrix()->copyFrom(part.matrix);
+            surface->geometry(part.geometry);
+            surface->material(part.material);
+            surface->effect(part.effect);
+            surface->visible(true);
+        }
+        else
+            surface->visible(false);
+    }
+}
+
+void
+RoadScript::placeProp(Chunk& chunk, int side, int propId)
+{
+    auto prop = chunk.props[side][propId];
+
+    applySkin(prop, _propSkins[chunk.layout.props[side][propId]]);
+
+    if (side == 1)
+        prop->component<Transform>()->matrix()->prependRotationY(float(M_PI));
+
+    prop->component<Transform>()->matrix()
+        ->appendTranslation(0.f, 0.f, chunk.layout.propOffsets[side][propId]);
+
+#ifdef TREX_ENABLE_IMPOSTORS
+    const auto& impostor = _impostorBaker->impostor(chunk.layout.props[side][propId]);
+    auto impostorSlot = chunk.impostors[side][propId];
+    auto quad = impostorSlot->children().front();
+
+    impostorSlot->component<Transform>()->matrix()->copyFrom(prop->component<Transform>()->matrix());
+    quad->component<Transform>()->matrix()->copyFrom(impostor.matrix);
+    quad->component<Surface>()->material(impostor.material);
+#endif
+}
+
+void
+RoadScript::bakeImpostors(file::AssetLibrary::Ptr assets)
+{
+    _impostorBaker = ImpostorBaker::create(assets->context(), assets->effect("effect/Phong.effect"));
+
+    // impostor i stands for _propSkins[i]
+    for (const auto& skin : _propSkins)
+    {
+        auto model = createSkinSlot({ skin });
+
+        applySkin(model, skin);
+        _impostorBaker->add(model);
+    }
+
+    _impostorBaker->bake();
+}
+
+scene::Node::Ptr
+RoadScript::createImpostorSlot()
+{
+    const auto& impostor = _impostorBaker->impostor(0);
+
+    return scene::Node::create("impostor")
+        ->addComponent(Transform::create())
+        ->addChild(scene::Node::create()
+            ->addComponent(Transform::create())
+            ->addComponent(Surface::create(_impostorBaker->quad(), impostor.material, _impostorBaker->effect()))
+        );
 }
 
 void
-RoadScript::initializeChunkSide(minko::scene::Node::Ptr side, int index)
+RoadScript::mergeChunkSide(Chunk& chunk, int side)
 {
+#ifdef TREX_ENABLE_CHUNK_MERGING
+    // the prop offsets only depend on the prop ids, so they identify the side geometry
+    auto signature = 0;
+
+    for (auto propId = 0; propId < TREX_ROAD_CHUNK_NUM_PROPS; ++propId)
+        signature = signature * TREX_ROAD_NUM_PROP_MODELS + chunk.layout.props[side][propId];
 
-    auto numProps = TREX_ROAD_CHUNK_MIN_PROPS
-        + (rand() % (TREX_ROAD_CHUNK_MAX_PROPS - TREX_ROAD_CHUNK_MIN_PROPS));
+    if (signature == chunk.mergedSignatures[side])
+        return;
 
-    numProps = 5;
+    chunk.mergedSignatures[side] = signature;
+    _meshMerger->reset();
 
-    for (auto propId = 0; propId < numProps; ++propId)
+    for (auto propId = 0; propId < TREX_ROAD_CHUNK_NUM_PROPS; ++propId)
     {
-        auto r = 0;
-        do{
-            r = rand() % 5;
-        } while (r == _prevRandomNum);
+        auto propMatrix = chunk.props[side][propId]->component<Transform>()->matrix();
+        const auto& skin = _propSkins[chunk.layout.props[side][propId]];
 
-        _prevRandomNum = r;
+        for (const auto& part : skin.parts)
+            _meshMerger->add(part.geometry, Matrix4x4::create()->copyFrom(part.matrix)->append(propMatrix));
+    }
 
-        auto prop = _props[r]->clone(CloneOption::SHALLOW);
+    auto sideNode = chunk.sides[side];
+    auto merged = chunk.mergedSides[side];
+    auto geometry = _meshMerger->build();
+    geometry::Geometry::Ptr previousGeometry = merged != nullptr ? merged->component<Surface>()->geometry() : nullptr;
 
-        // FIXME
-        const float propSize = float(TREX_ROAD_CHUNK_LENGTH / numProps);
+    if (geometry == nullptr)
+    {
+        // the side cannot be merged (incompatible vertex formats or more than 65535 vertices)
+        if (merged != nullptr && merged->parent() == sideNode)
+            sideNode->removeChild(merged);
 
-        auto ratio = 1;
-        if (side->name() == "right")
+        for (auto prop : chunk.props[side])
+            if (prop->parent() != sideNode)
+                sideNode->addChild(prop);
+    }
+    else
+    {
+        // every map_block model shares the same textures, so the first material stands for all of them
+        const auto& part = _propSkins[chunk.layout.props[side][0]].parts.front();
+
+        if (merged == nullptr)
         {
-            ratio = -1;
+            merged = scene::Node::create("merged")
+                ->addComponent(Transform::create())
+                ->addComponent(Surface::create(geometry, part.material, part.effect));
+            chunk.mergedSides[side] = merged;
         }
+        else
+            merged->component<Surface>()->geometry(geometry);
 
-        if (ratio == -1)
-            prop->component<Transform>()->matrix()->prependRotationY(float(M_PI));
+        if (merged->parent() != sideNode)
+            sideNode->addChild(merged);
 
-        prop->component<Transform>()->matrix()
-            ->appendTranslation(0.f, 0.f, (propId * propSize));
+        for (auto prop : chunk.props[side])
+            if (prop->parent() == sideNode)
+                sideNode->removeChild(prop);
+    }
 
-        side->addChild(prop);
+    // the previous merged geometry is kept by the detached node until it is replaced
+    if (geometry != nullptr && previousGeometry != nullptr)
+    {
+        for (auto vertexBuffer : previousGeometry->vertexBuffers())
+            vertexBuffer->dispose();
+        previousGeometry->indices()->dispose();
     }
+#endif
+}
+
+LodSwitch::Ptr
+RoadScript::createLodSwitch(scene::Node::Ptr parent, scene::Node::Ptr node, float maxDistance)
+{
+    auto lodSwitch = LodSwitch::create()->addLevel(maxDistance, node);
 
+    parent->addChild(scene::Node::create("lod")
+        ->addComponent(Transform::create())
+        ->addComponent(lodSwitch)
+    );
+
+    return lodSwitch;
 }
 
 void
-RoadScript::createObstacle(SceneManager::Ptr sceneManager, int i)
+RoadScript::updateLods(float carZ)
 {
+    for (unsigned int i = 0; i < _numActiveChunks; ++i)
+    {
+        const auto& slot = activeChunk(i);
+        const auto& chunk = _chunks[slot.id];
+        // distance from the car to the nearest end of the chunk
+        auto sideDistance = std::max(0.f, std::max(slot.z - carZ, carZ - slot.z - TREX_ROAD_CHUNK_LENGTH));
+
+        for (auto lodSwitch : chunk.sideLods)
+            lodSwitch->update(sideDistance);
+
+        for (auto lodSwitch : chunk.decorationLods)
+            lodSwitch->update(sideDistance);
+
+        for (unsigned int obstacleId = 0; obstacleId < chunk.obstacleLods.size(); ++obstacleId)
+            chunk.obstacleLods[obstacleId]->update(std::abs(slot.z + chunk.layout.obstacles[obstacleId].z - carZ));
+    }
+}
 
-    int id = abs(rand() * i) % 4;
-    auto pos = (i % 3 - 1) * TREX_ROAD_WIDTH / 3.2;
-    auto trans = Transform::create(Matrix4x4::create()
-        ->translation(pos, 0.f, TREX_ROAD_CHUNK_LENGTH / 2.f));
-    auto mesh = _trunkModels[id]->clone(CloneOption::SHALLOW);
+static
+float
+obstacleX(int lane)
+{
+    // lane 0 is on the left (+x), lane 2 on the right (-x)
+    return float(1 - lane) * TREX_ROAD_WIDTH / 3.2f;
+}
+
+void
+RoadScript::createObstacle(Chunk& chunk)
+{
+    auto mesh = createSkinSlot(_trunkSkins);
+
+    chunk.obstacles.push_back(mesh);
+    // no lower detail variant of the trunks: past the fog end they are only culled
+    chunk.obstacleLods.push_back(createLodSwitch(chunk.node, mesh, TREX_FOG_END));
+}
+
+void
+RoadScript::placeObstacle(Chunk& chunk, int obstacleId)
+{
+    auto mesh = chunk.obstacles[obstacleId];
+    const auto& obstacle = chunk.layout.obstacles[obstacleId];
+
+    applySkin(mesh, _trunkSkins[obstacle.model]);
 
     mesh->component<Transform>()->matrix()
         ->appendScale(2)
-        ->appendTranslation(pos, 0.f, TREX_ROAD_CHUNK_LENGTH / 2.f);
-    _obstacles.push_back(mesh);
+        ->appendTranslation(obstacleX(obstacle.lane), 0.f, obstacle.z);
+
+    if (obstacleId >= chunk.layout.numObstacles)
+        for (auto part : mesh->children())
+            part->component<Surface>()->visible(false);
+}
+
+void
+RoadScript::showObstacle(scene::Node::Ptr obstacle)
+{
+    for (const auto& chunk : _chunks)
+    {
+        for (auto obstacleId = 0; obstacleId < chunk.layout.numObstacles; ++obstacleId)
+        {
+            if (chunk.obstacles[obstacleId] != obstacle)
+                continue;
+
+            const auto& skin = _trunkSkins[chunk.layout.obstacles[obstacleId].model];
+            const auto& partNodes = obstacle->children();
+
+            for (unsigned int partId = 0; partId < partNodes.size(); ++partId)
+                partNodes[partId]->component<Surface>()->visible(partId < skin.parts.size());
+
+            return;
+        }
+    }
+}
+
+void
+RoadScript::indexChunkObstacles(int chunkId)
+{
+    const auto& chunk = _chunks[chunkId];
+
+    _obstacleIndex->clearChunk(chunkId);
+
+    for (auto obstacleId = 0; obstacleId < chunk.layout.numObstacles; ++obstacleId)
+    {
+        auto mesh = chunk.obstacles[obstacleId];
+        auto transform = mesh->component<Transform>();
+
+        _obstacleIndex->addObstacle(
+            chunkId,
+            mesh,
+            chunk.layout.obstacles[obstacleId].lane,
+            transform->x(),
+            transform->z(),
+            TREX_OBSTACLE_WIDTH,
+            TREX_OBSTACLE_LENGTH
+        );
+    }
+}
+
+void
+RoadScript::applyChunkLayout(int chunkId, const ChunkLayout& layout)
+{
+    auto& chunk = _chunks[chunkId];
+    const auto previous = chunk.layout;
+
+    chunk.layout = layout;
+
+    for (auto side = 0; side < 2; ++side)
+    {
+        for (auto propId = 0; propId < TREX_ROAD_CHUNK_NUM_PROPS; ++propId)
+            placeProp(chunk, side, propId);
+
+        mergeChunkSide(chunk, side);
+    }
+
+#ifdef TREX_ENABLE_LIGHTWELL
+    chunk.lightWell->component<Transform>()->matrix()->appendTranslation(
+        layout.lightWellX - previous.lightWellX,
+        0.f,
+        layout.lightWellZ - previous.lightWellZ
+    );
+    chunk.liana->component<Transform>()->matrix()
+        ->appendTranslation(0.f, 0.f, layout.lianaZ - previous.lianaZ);
+#endif
+
+#ifdef ROAD_COLLISION_ENABLE
+    for (auto obstacleId = 0; obstacleId < TREX_ROAD_CHUNK_MAX_OBSTACLES; ++obstacleId)
+        placeObstacle(chunk, obstacleId);
+
+    indexChunkObstacles(chunkId);
+#endif
 }
 
 void
 RoadScript::update(scene::Node::Ptr target)
 {
 #ifdef ROAD_COLLISION_ENABLE
-    auto manageCar = _car->component<trex::component::CarScript>();
-    int posCarZ = int(_car->component<Transform>()->z());
+    // collisions are swept between two checks, so they can run at a lower rate than rendering
+    _collisionTime += deltaTime();
+
+    if (_collisionTime >= ROAD_COLLISION_INTERVAL)
+    {
+        _collisionTime = std::fmod(_collisionTime, ROAD_COLLISION_INTERVAL);
+
+        auto manageCar = _car->component<trex::component::CarScript>();
+        auto posCarZ = manageCar->world()->position(WorldCache::CAR).z;
 
-    checkCollision(manageCar, posCarZ);
+        checkCollision(manageCar, posCarZ);
+    }
 #endif
 
     manageChunks(_car, target);
+    updateLods(_car->component<trex::component::CarScript>()->world()->position(WorldCache::CAR).z);
 }
 
 void
 RoadScript::manageChunks(scene::Node::Ptr camera, scene::Node::Ptr target)
 {
 
-    auto currentPosition = camera->component<Transform>()->z();
+    auto currentPosition = camera->component<trex::component::CarScript>()->world()->position(WorldCache::CAR).z;
 
     auto furtherFrontChunkPosition = 0;
-    auto furtherBackChunkPosition = 10000;
-    if (_activeChunks.size() > 0)
+    if (_numActiveChunks > 0)
     {
-        furtherFrontChunkPosition = int(_activeChunks.back()->component<Transform>()->z());
-        furtherBackChunkPosition = int(_activeChunks.front()->component<Transform>()->z());
+        furtherFrontChunkPosition = int(activeChunk(_numActiveChunks - 1).z);
     }
     else
     {
@@ -271,58 +652,113 @@ RoadScript::manageChunks(scene::Node::Ptr camera, scene::Node::Ptr target)
 void
 RoadScript::addFrontChunk(scene::Node::Ptr target)
 {
-    auto index = rand() % _stockChunks.size();
+    const auto numStockChunks = _chunkRing.size() - _numActiveChunks;
+
+    if (numStockChunks == 0)
+        return;
+
     auto furtherFrontChunkPosition = float(-TREX_ROAD_CHUNK_LENGTH * 4);
-    if (_activeChunks.size() > 0)
+    if (_numActiveChunks > 0)
     {
-        furtherFrontChunkPosition = std::floor(_activeChunks.back()->component<Transform>()->modelToWorldMatrix(true)->transform(Vector3::create())->z());
+        furtherFrontChunkPosition = activeChunk(_numActiveChunks - 1).z;
     }
     auto newPosZ = furtherFrontChunkPosition + (float)TREX_ROAD_CHUNK_LENGTH;
-    auto chunkAdded = _stockChunks[index];
-    chunkAdded->component<Transform>()->matrix()->identity();
-    chunkAdded->component<Transform>()->matrix()->appendTranslation(0., 0., newPosZ);
-    _activeChunks.push_back(chunkAdded);
 
-    _stockChunks.erase(_stockChunks.begin() + index);
+    // pick a random stock chunk and swap it in the slot right after the front chunk
+    auto& slot = activeChunk(_numActiveChunks);
+    std::swap(slot, activeChunk(_numActiveChunks + rand() % numStockChunks));
+
+    // the simulation must be reproducible from its seed, so it always waits for a layout
+    ChunkLayout layout;
+#ifdef TREX_HEADLESS
+    const auto waitForLayout = true;
+#else
+    const auto waitForLayout = false;
+#endif
+
+    if (_chunkGenerator->next(layout, waitForLayout))
+        applyChunkLayout(slot.id, layout);
+
+    slot.z = newPosZ;
+    slot.node->component<Transform>()->matrix()
+        ->identity()
+        ->appendTranslation(0.f, 0.f, newPosZ);
+    _obstacleIndex->placeChunk(slot.id, newPosZ);
+    target->addChild(slot.node);
+
+    ++_numActiveChunks;
 }
 
 void
 RoadScript::removeBackChunk(scene::Node::Ptr target)
 {
-    _stockChunks.push_back(_activeChunks[0]);
-    _activeChunks[0]->component<Transform>()->matrix()
-        ->identity()
-        ->appendTranslation(0.f, -50.f, 0.f);
+    if (_numActiveChunks == 0)
+        return;
+
+    auto& slot = activeChunk(0);
+
+    _obstacleIndex->removeChunk(slot.id);
+    slot.z = 0.f;
+    target->removeChild(slot.node);
+
+    _firstActiveChunk = (_firstActiveChunk + 1) % _chunkRing.size();
+    --_numActiveChunks;
+}
+
+void
+RoadScript::shiftOrigin(float shift)
+{
+    for (unsigned int i = 0; i < _numActiveChunks; ++i)
+        _obstacleIndex->removeChunk(activeChunk(i).id);
+
+    for (unsigned int i = 0; i < _numActiveChunks; ++i)
+    {
+        auto& slot = activeChunk(i);
 
-    _activeChunks.erase(_activeChunks.begin());
+        slot.z -= shift;
+        slot.node->component<Transform>()->matrix()->appendTranslation(0.f, 0.f, -shift);
+        _obstacleIndex->placeChunk(slot.id, slot.z);
+    }
+
+    _lastCollision -= shift;
+    _previousCarZ -= shift;
 }
 
 void
 RoadScript::playHitSound()
 {
+#ifndef TREX_HEADLESS
     static auto sceneManager = _car->root()->component<SceneManager>();
     static auto channel = sceneManager->assets()->sound("sound/car_hit_1.ogg")->play(1);
+#endif
 }
 
 void
-RoadScript::checkCollision(CarScript::Ptr manageCar, int posCarZ)
+RoadScript::checkCollision(CarScript::Ptr manageCar, float posCarZ)
 {
-    int lane = manageCar->lane() - 1;
+    auto previousCarZ = _previousCarZ;
+
+    _previousCarZ = posCarZ;
+
+    if (posCarZ <= 0.f)
+        return;
+
+    // car box swept from its previous position to the current one
+    auto carX = manageCar->lateralPosition();
+    auto obstacleZ = 0.f;
+    auto obstacle = _obstacleIndex->find(
+        carX - CAR_WIDTH / 2.f,
+        carX + CAR_WIDTH / 2.f,
+        std::min(previousCarZ, posCarZ) - CAR_LENGTH / 2.f,
+        std::max(previousCarZ, posCarZ) + CAR_LENGTH / 2.f,
+        _lastCollision,
+        obstacleZ
+    );
 
-    if (posCarZ > 0 && posCarZ != _lastCollision)
+    if (obstacle != nullptr)
     {
-        for (unsigned int i = 0; i < _obstacles.size(); i++)
-        {
-            if (posCarZ == int(_obstacles[i]->component<Transform>()->z()))
-            {
-                int posObstacleX = int(_obstacles[i]->component<Transform>()->x());
-
-                if (posObstacleX * lane < 0 || (posObstacleX == 0 && lane == 0))
-                    manageCollision(manageCar, _obstacles[i]);
-                _lastCollision = posCarZ;
-                break;
-            }
-        }
+        _lastCollision = obstacleZ;
+        manageCollision(manageCar, obstacle->node);
     }
 }
 
@@ -22,7 +22,12 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "minko/Minko.hpp"
 
 #include "trex/Config.hpp"
+#include "trex/ObstacleIndex.hpp"
+#include "trex/ChunkGenerator.hpp"
+#include "trex/MeshMerger.hpp"
+#include "trex/ImpostorBaker.hpp"
 #include "trex/component/CarScript.hpp"
+#include "trex/component/LodSwitch.hpp"
 
 namespace trex
 {
@@ -41,6 +46,52 @@ namespace trex
         public:
             typedef std::shared_ptr<RoadScript>     Ptr;
 
+        private:
+            typedef minko::Signal<float>::Slot      OriginShiftedSlot;
+
+            // Chunks are kept in a fixed-capacity ring: the active chunks are the
+            // _numActiveChunks slots following _firstActiveChunk, the others are in stock.
+            struct ChunkSlot
+            {
+                minko::scene::Node::Ptr node;
+                int                     id;
+                float                   z;
+            };
+
+            // The surfaces of a model, flattened in model space, so that a pooled slot
+            // can be re-skinned as any model without cloning nodes.
+            struct ModelSkin
+            {
+                struct Part
+                {
+                    minko::geometry::Geometry::Ptr  geometry;
+                    minko::material::Material::Ptr  material;
+                    minko::render::Effect::Ptr      effect;
+                    minko::math::Matrix4x4::Ptr     matrix;
+                };
+
+                minko::math::Matrix4x4::Ptr         matrix;
+                std::vector<Part>                   parts;
+            };
+
+            struct Chunk
+            {
+                minko::scene::Node::Ptr                 node;
+                std::array<minko::scene::Node::Ptr, 2>  sides;
+                std::array<std::array<minko::scene::Node::Ptr, TREX_ROAD_CHUNK_NUM_PROPS>, 2>   props;
+                std::array<minko::scene::Node::Ptr, 2>  impostorSides;
+                std::array<std::array<minko::scene::Node::Ptr, TREX_ROAD_CHUNK_NUM_PROPS>, 2>   impostors;
+                minko::scene::Node::Ptr                 lightWell;
+                minko::scene::Node::Ptr                 liana;
+                std::vector<minko::scene::Node::Ptr>    obstacles;
+                std::array<LodSwitch::Ptr, 2>           sideLods;
+                std::vector<LodSwitch::Ptr>             decorationLods;
+                std::vector<LodSwitch::Ptr>             obstacleLods;
+                ChunkLayout                             layout;
+                std::array<minko::scene::Node::Ptr, 2>  mergedSides;
+                std::array<int, 2>                      mergedSignatures;
+            };
+
         private:
             std::vector<minko::scene::Node::Ptr>    _props;
             minko::scene::Node::Ptr                 _lightWell;
@@ -49,19 +100,31 @@ namespace trex
             minko::scene::Node::Ptr                 _lianaModel;
             minko::scene::Node::Ptr                 _invisibleTrunk;
             std::vector<minko::scene::Node::Ptr>    _trunkModels;
-            std::vector<minko::scene::Node::Ptr>    _activeChunks;
-            std::vector<minko::scene::Node::Ptr>    _stockChunks;
-            std::vector<minko::scene::Node::Ptr>    _obstacles;
+            std::vector<ModelSkin>                  _propSkins;
+            std::vector<ModelSkin>                  _trunkSkins;
+            std::vector<Chunk>                      _chunks;
+            std::vector<ChunkSlot>                  _chunkRing;
+            unsigned int                            _firstActiveChunk;
+            unsigned int                            _numActiveChunks;
+            ObstacleIndex::Ptr                      _obstacleIndex;
+            ChunkGenerator::Ptr                     _chunkGenerator;
+            MeshMerger::Ptr                         _meshMerger;
+            ImpostorBaker::Ptr                      _impostorBaker;
             std::vector<int>                        _lastChunkSide;
-            int                                     _lastCollision;
-            int                                     _prevRandomNum;
+            float                                   _lastCollision;
+            float                                   _previousCarZ;
+            float                                   _collisionTime;
             int                                     _invisibleTime;
+            OriginShiftedSlot                       _originShiftedSlot;
 
         private:
             RoadScript(minko::scene::Node::Ptr car) :
                 _car(car),
-                _lastCollision(-1),
-                _prevRandomNum(0),
+                _firstActiveChunk(0),
+                _numActiveChunks(0),
+                _lastCollision(0.f),
+                _previousCarZ(0.f),
+                _collisionTime(0.f),
                 _invisibleTime(-1)
             {
             }
@@ -103,6 +166,10 @@ namespace trex
                 return _invisibleTrunk;
             }
 
+            // Shows back an obstacle hidden by a collision, only with the parts of its current skin.
+            void
+            showObstacle(minko::scene::Node::Ptr obstacle);
+
         protected:
             void
             initialize();
@@ -123,13 +190,56 @@ namespace trex
             initializeGround(minko::file::AssetLibrary::Ptr assets);
 
             void
-            initializeChunk(minko::scene::Node::Ptr chunk, minko::file::AssetLibrary::Ptr );
+            initializeChunk(Chunk& chunk, const ChunkLayout& layout);
+
+            void
+            initializeChunkSide(Chunk& chunk, int index, const ChunkLayout& layout);
+
+            void
+            createObstacle(Chunk& chunk);
+
+            ModelSkin
+            createSkin(minko::scene::Node::Ptr symbol);
+
+            minko::scene::Node::Ptr
+            createSkinSlot(const std::vector<ModelSkin>& skins);
+
+            void
+            applySkin(minko::scene::Node::Ptr slot, const ModelSkin& skin);
+
+            void
+            placeProp(Chunk& chunk, int side, int propId);
+
+            void
+            bakeImpostors(minko::file::AssetLibrary::Ptr assets);
+
+            minko::scene::Node::Ptr
+            createImpostorSlot();
+
+            void
+            placeObstacle(Chunk& chunk, int obstacleId);
+
+            void
+            mergeChunkSide(Chunk& chunk, int side);
+
+            LodSwitch::Ptr
+            createLodSwitch(minko::scene::Node::Ptr parent, minko::scene::Node::Ptr node, float maxDistance);
 
             void
-            initializeChunkSide(minko::scene::Node::Ptr side, int index);
+            updateLods(float carZ);
 
             void
-            createObstacle(minko::component::SceneManager::Ptr, int i);
+            applyChunkLayout(int chunkId, const ChunkLayout& layout);
+
+            void
+            indexChunkObstacles(int chunkId);
+
+            inline
+            ChunkSlot&
+            activeChunk(unsigned int index)
+            {
+                return _chunkRing[(_firstActiveChunk + index) % _chunkRing.size()];
+            }
 
             void
             manageChunks(minko::scene::Node::Ptr camera, minko::scene::Node::Ptr target);
@@ -141,7 +251,10 @@ namespace trex
             removeBackChunk(minko::scene::Node::Ptr target);
 
             void
-            checkCollision(trex::component::CarScript::Ptr manageCar, int posCarZ);
+            shiftOrigin(float shift);
+
+            void
+            checkCollision(trex::component::CarScript::Ptr manageCar, float posCarZ);
 
             void
             manageCollision(CarScript::Ptr manageCar, minko::scene::Node::Ptr collision);
@@ -108,16 +108,7 @@ RumbleScript::trunkManage()
         std::cout << "invisibleTime: " << invisibleTime << std::endl;
         if (invisibleTime > 2)
         {
-            auto trunk = manageRoad->invisibleTrunk();
-            auto trunkNodes = scene::NodeSet::create(trunk)
-                ->descendants(false)
-                ->where([](scene::Node::Ptr n)
-            {
-                return n->hasComponent<Surface>();
-            });
-
-            for (scene::Node::Ptr n : trunkNodes->nodes())
-                n->component<Surface>()->visible(true);
+            manageRoad->showObstacle(manageRoad->invisibleTrunk());
             manageRoad->invisibleTime(-1);
             std::cout << "Trunk reappears!" << std::endl;
         }
@@ -0,0 +1,182 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ScoreBoard.hpp"
+#include "trex/MeshMerger.hpp"
+
+using namespace minko;
+using namespace minko::component;
+using namespace minko::math;
+using namespace trex::component;
+
+unsigned int
+ScoreBoard::addCounter(const std::vector<scene::Node::Ptr>& digits, float vOffset)
+{
+    Counter counter;
+
+    counter.vOffset = vOffset;
+    counter.value = -1;
+
+    for (auto node : digits)
+    {
+        auto material = std::static_pointer_cast<material::BasicMaterial>(node->component<Surface>()->material());
+
+        counter.digits.push_back({ node, material, -1, 0, std::vector<float>() });
+    }
+
+    _counters.push_back(counter);
+
+    return _counters.size() - 1;
+}
+
+void
+ScoreBoard::value(unsigned int counterId, int value)
+{
+    auto& counter = _counters[counterId];
+
+    if (value == counter.value)
+        return;
+
+    counter.value = value;
+
+    auto changed = false;
+
+    // leading digits are reset to 0
+    for (auto& digit : counter.digits)
+    {
+        auto digitValue = value % 10;
+
+        if (digit.value != digitValue)
+        {
+            writeDigit(counter, digit, digitValue);
+            changed = true;
+        }
+
+        value /= 10;
+    }
+
+    if (changed && _vertexBuffer != nullptr)
+        _vertexBuffer->upload();
+}
+
+void
+ScoreBoard::writeDigit(const Counter& counter, Digit& digit, int value)
+{
+    digit.value = value;
+
+    if (_vertexBuffer == nullptr)
+    {
+        digit.material->uvOffset(0.1f * value, counter.vOffset);
+
+        return;
+    }
+
+    auto& data = _vertexBuffer->data();
+    const auto vertexSize = _vertexBuffer->vertexSize();
+
+    for (unsigned int i = 0; i < digit.uvs.size(); i += 2)
+    {
+        auto* uv = &data[(digit.firstVertex + i / 2) * vertexSize + _uvOffset];
+
+        uv[0] = digit.uvs[i] + 0.1f * value;
+        uv[1] = digit.uvs[i + 1] + counter.vOffset;
+    }
+}
+
+bool
+ScoreBoard::merge(render::AbstractContext::Ptr context, render::Effect::Ptr effect)
+{
+    if (targets().empty() || _counters.empty() || _counters.front().digits.empty() || _merged != nullptr)
+        return false;
+
+    auto board = targets().front();
+    auto merger = MeshMerger::create(context);
+    std::vector<std::pair<unsigned int, unsigned int>> vertexRanges;
+
+    for (const auto& counter : _counters)
+    {
+        for (const auto& digit : counter.digits)
+        {
+            auto matrix = Matrix4x4::create();
+            auto firstVertex = merger->numVertices();
+
+            for (auto n = digit.node; n != board && n != nullptr; n = n->parent())
+                if (n->hasComponent<Transform>())
+                    matrix->append(n->component<Transform>()->matrix());
+
+            if (!merger->add(digit.node->component<Surface>()->geometry(), matrix))
+                return false;
+
+            vertexRanges.push_back({ firstVertex, merger->numVertices() - firstVertex });
+        }
+    }
+
+    auto geometry = merger->build();
+
+    if (geometry == nullptr)
+        return false;
+
+    _vertexBuffer = geometry->vertexBuffers().front();
+    if (!_vertexBuffer->hasAttribute("uv"))
+    {
+        _vertexBuffer = nullptr;
+
+        return false;
+    }
+    _uvOffset = std::get<2>(*_vertexBuffer->attribute("uv"));
+
+    // the uv offsets are now baked in the vertices: the shared material is not offset anymore
+    auto material = _counters.front().digits.front().material;
+
+    material->uvOffset(0.f, 0.f);
+
+    const auto& data = _vertexBuffer->data();
+    const auto vertexSize = _vertexBuffer->vertexSize();
+    auto rangeId = 0;
+
+    for (auto& counter : _counters)
+    {
+        for (auto& digit : counter.digits)
+        {
+            const auto& range = vertexRanges[rangeId++];
+
+            digit.firstVertex = range.first;
+            digit.uvs.clear();
+
+            for (auto i = range.first; i < range.first + range.second; ++i)
+            {
+                digit.uvs.push_back(data[i * vertexSize + _uvOffset]);
+                digit.uvs.push_back(data[i * vertexSize + _uvOffset + 1]);
+            }
+
+            writeDigit(counter, digit, std::max(digit.value, 0));
+
+            digit.node->parent()->removeChild(digit.node);
+        }
+    }
+
+    _vertexBuffer->upload();
+
+    _merged = scene::Node::create("scoreBoard")
+        ->addComponent(Transform::create())
+        ->addComponent(Surface::create(geometry, material, effect));
+    board->addChild(_merged);
+
+    return true;
+}
@@ -0,0 +1,92 @@
+/*
+Copyright (c) 2014 Aerys
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "minko/Minko.hpp"
+
+#include "trex/Config.hpp"
+
+namespace trex
+{
+    namespace component
+    {
+        // Displays numbers with digit quads mapped on the counter atlas: digit d of a counter
+        // is shown by offsetting its uvs by (0.1 * d, vOffset). Only the digits that changed
+        // since the last value are written. Once merged, all the digits of the board are
+        // drawn as a single surface whose uvs are rewritten instead of the materials.
+        class ScoreBoard : public minko::component::AbstractComponent
+        {
+        public:
+            typedef std::shared_ptr<ScoreBoard> Ptr;
+
+        private:
+            struct Digit
+            {
+                minko::scene::Node::Ptr                         node;
+                std::shared_ptr<minko::material::BasicMaterial> material;
+                int                                             value;
+                unsigned int                                    firstVertex;
+                std::vector<float>                              uvs;
+            };
+
+            struct Counter
+            {
+                std::vector<Digit>  digits;
+                float               vOffset;
+                int                 value;
+            };
+
+        private:
+            std::vector<Counter>                    _counters;
+            minko::scene::Node::Ptr                 _merged;
+            minko::render::VertexBuffer::Ptr        _vertexBuffer;
+            unsigned int                            _uvOffset;
+
+        public:
+            static
+            Ptr
+            create()
+            {
+                return std::shared_ptr<ScoreBoard>(new ScoreBoard());
+            }
+
+            // Digits are given from the least significant one; returns the id of the counter.
+            unsigned int
+            addCounter(const std::vector<minko::scene::Node::Ptr>& digits, float vOffset);
+
+            void
+            value(unsigned int counterId, int value);
+
+            // Merges the digits of every counter in a single surface, in the space of the target
+            // of the board. Returns false, leaving the digits as they are, if they cannot be merged.
+            bool
+            merge(minko::render::AbstractContext::Ptr context, minko::render::Effect::Ptr effect);
+
+        private:
+            ScoreBoard() :
+                _uvOffset(0)
+            {
+            }
+
+            void
+            writeDigit(const Counter& counter, Digit& digit, int value);
+        };
+    }
+}